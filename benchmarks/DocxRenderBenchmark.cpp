@@ -0,0 +1,128 @@
+// Scaling of WordGenerator's parallel tag rendering, checked against the serial path. The same price list is
+// written with 1 render thread (reference) and with 2, 4, 8 and one per core; word/document.xml of every run
+// must equal the reference byte for byte. Entries are stored, not deflated, so the timings are the rendering.
+//
+// Usage: DocxRenderBenchmark [rows] (default 20000; each row is 1-3 tags)
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+#include <cstdio>
+
+#include "WordGenerator.h"
+#include "XlsxZipArchive.h"
+#include "pricetag.h"
+#include "pricetagtable.h"
+
+
+namespace
+{
+    // Mostly distinct rows, so the per-window fragment cache does not hide the rendering cost
+    PriceTagTable makeTable (int rows)
+    {
+        PriceTagTable table;
+        table.reserve (rows);
+
+        for (int i = 0; i < rows; ++i)
+        {
+            PriceTag tag (QString (), QString (), 1000 + i % 9000, 1 + i % 3);
+
+            tag.setBrand ("Brand " + QString::number (i % 500));
+            tag.setCategory ("Category " + QString::number (i % 40));
+            tag.setBrandCountry ("Россия");
+            tag.setManufacturingPlace (i % 3 ? "Китай" : "Турция");
+            tag.setMaterial ("Хлопок " + QString::number (50 + i % 50) + "%");
+            tag.setArticle ("ART-" + QString::number (100000 + i));
+            tag.setSupplier ("ООО \"Поставщик " + QString::number (i % 40) + "\"");
+            tag.setAddress ("г. Москва, ул. Тверская, д. " + QString::number (1 + i % 90) + ", ТЦ \"Галерея\", 2 этаж");
+
+            if (i % 4 == 0)
+                tag.setPrice2 (double (900 + i % 8000));
+
+            table.append (tag);
+        }
+
+
+        return table;
+    }
+
+    // Milliseconds for one document, and its document.xml
+    qint64 render (WordGenerator &generator, const PriceTagTable &table, int threads, const QString &path, QByteArray &documentXml)
+    {
+        QThreadPool::globalInstance ()->setMaxThreadCount (threads);
+        generator.setRenderThreads (threads);
+
+        QElapsedTimer timer;
+        timer.start ();
+
+        if (! generator.generateWordDocument (table, path))
+            return -1;
+
+        const qint64 elapsed = timer.elapsed ();
+
+        documentXml = XlsxZipArchive (path).fileData ("word/document.xml");
+
+
+        return elapsed;
+    }
+} // namespace
+
+
+int main (int argc, char *argv[])
+{
+    QCoreApplication app (argc, argv);
+
+    const int rows	   = argc > 1 ? qMax (1, QByteArray (argv[1]).toInt ()) : 20000;
+    const int cores	   = QThread::idealThreadCount ();
+    const QString path = QDir::temp ().filePath ("DocxRenderBenchmark.docx");
+
+    const PriceTagTable table = makeTable (rows);
+
+    WordGenerator generator;
+    generator.setCompression (ZipCompression::Store);
+
+
+    QByteArray reference;
+    const qint64 serialMs = render (generator, table, 1, path, reference);
+
+    if (serialMs < 0 || reference.isEmpty ())
+    {
+        std::fprintf (stderr, "Serial run failed\n");
+
+        return 1;
+    }
+
+    std::printf ("%d rows, %d cores, document.xml %lld bytes\n", rows, cores, static_cast<long long> (reference.size ()));
+    std::printf ("threads  1: %6lld ms (reference)\n", static_cast<long long> (serialMs));
+
+
+    QVector<int> threadCounts = {2, 4, 8};
+
+    if (! threadCounts.contains (cores) && cores > 1)
+        threadCounts.append (cores);
+
+    bool identical = true;
+
+    for (int threads : threadCounts)
+    {
+        QByteArray xml;
+        const qint64 ms = render (generator, table, threads, path, xml);
+
+        const bool same = ms >= 0 && xml == reference;
+        identical		= identical && same;
+
+        std::printf ("threads %2d: %6lld ms, %.2fx, %s\n", threads, static_cast<long long> (ms),
+                     double (serialMs) / double (qMax<qint64> (1, ms)), same ? "identical" : "DIFFERENT");
+    }
+
+    QFile::remove (path);
+
+
+    return identical ? 0 : 1;
+}
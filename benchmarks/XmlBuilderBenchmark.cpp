@@ -0,0 +1,315 @@
+// Per-tag XML cost of WordGenerator's inner tag table, built the way it was before XmlByteBuilder (QString::arg
+// chains joined with += and converted with toUtf8) and the way it is built now (appends into one byte buffer).
+// Both sides are copies of the respective WordGenerator helpers and must produce the same bytes.
+//
+// Usage: XmlBuilderBenchmark [tags] (default 100000)
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <cstdio>
+
+#include "XmlByteBuilder.h"
+#include "XmlEscape.h"
+
+
+namespace
+{
+    struct Sample
+    {
+        QString brand;
+        QString category;
+        QString brandCountry;
+        QString manufacturingPlace;
+        QString material;
+        QString article;
+        QString supplier;
+        QString address1;
+        QString address2;
+        QString price;
+        QString price2;
+    };
+
+    // Row heights and grid in twips; the values do not change the cost
+    const int rowHeights[] = {280, 300, 240, 240, 240, 220, 520, 220, 200, 200};
+    const int columnWidths[4] = {900, 700, 700, 700};
+
+
+    // ============================================ Before: QString::arg chains ============================================
+
+    QString paragraphBefore (const QString &text, const QString &styleId)
+    {
+        return QString ("<w:p><w:pPr><w:pStyle w:val=\"%1\"/></w:pPr><w:r><w:t xml:space=\"preserve\">%2</w:t></w:r></w:p>")
+                .arg (styleId, XmlEscape::escaped (text));
+    }
+
+    QString mergedRowBefore (int heightTwips, const QString &content, int borderSz)
+    {
+        QString tcBorders;
+
+        if (borderSz > 0)
+            tcBorders = QString ("<w:tcBorders><w:top w:val=\"single\" w:sz=\"%1\"/><w:bottom w:val=\"single\" w:sz=\"%1\"/></w:tcBorders>")
+                                .arg (borderSz);
+
+
+        return QString ("<w:tr><w:trPr><w:cantSplit/><w:trHeight w:val=\"%1\" w:hRule=\"exact\"/></w:trPr><w:tc><w:tcPr><w:tcW w:w=\"0\" "
+                        "w:type=\"auto\"/><w:gridSpan w:val=\"4\"/>%2</w:tcPr>%3</w:tc></w:tr>")
+                .arg (heightTwips)
+                .arg (tcBorders)
+                .arg (content);
+    }
+
+    QString twoCellRowBefore (int heightTwips, const QString &leftContent, const QString &rightContent, bool diagonalBL2TR,
+                              bool rightThickBorder, int borderSz)
+    {
+        QString leftBorders;
+
+        if (diagonalBL2TR)
+            leftBorders += "<w:tr2bl w:val=\"single\" w:sz=\"8\"/>";
+
+        if (borderSz > 0)
+            leftBorders += QString ("<w:top w:val=\"single\" w:sz=\"%1\"/><w:bottom w:val=\"single\" w:sz=\"%1\"/>").arg (borderSz);
+
+        QString leftTcPr = QString ("<w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/>") +
+                (leftBorders.isEmpty () ? QString () : QString ("<w:tcBorders>%1</w:tcBorders>").arg (leftBorders)) + "</w:tcPr>";
+
+
+        QString rightTcPr = "<w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/><w:gridSpan w:val=\"3\"/>";
+
+        if (rightThickBorder)
+            rightTcPr += "<w:tcBorders><w:top w:val=\"single\" w:sz=\"12\"/><w:left w:val=\"single\" w:sz=\"12\"/>"
+                         "<w:bottom w:val=\"single\" w:sz=\"12\"/><w:right w:val=\"single\" w:sz=\"12\"/></w:tcBorders>";
+        else if (borderSz > 0)
+            rightTcPr += QString ("<w:tcBorders><w:top w:val=\"single\" w:sz=\"%1\"/>"
+                                  "<w:bottom w:val=\"single\" w:sz=\"%1\"/></w:tcBorders>")
+                                 .arg (borderSz);
+        rightTcPr += "</w:tcPr>";
+
+
+        return QString ("<w:tr><w:trPr><w:cantSplit/><w:trHeight w:val=\"%1\" w:hRule=\"exact\"/></w:trPr>"
+                        "<w:tc>%2%3</w:tc>"
+                        "<w:tc>%4%5</w:tc>"
+                        "</w:tr>")
+                .arg (heightTwips)
+                .arg (leftTcPr)
+                .arg (leftContent)
+                .arg (rightTcPr)
+                .arg (rightContent);
+    }
+
+    QByteArray tagBefore (const Sample &s)
+    {
+        QString xml;
+
+        xml += "<w:tbl><w:tblPr><w:tblW w:w=\"%1\" w:type=\"dxa\"/><w:tblLayout w:type=\"fixed\"/>";
+        xml = xml.arg (3000);
+        xml += "</w:tblPr><w:tblGrid>";
+
+        for (int width : columnWidths)
+            xml += QString ("<w:gridCol w:w=\"%1\"/>").arg (width);
+        xml += "</w:tblGrid>";
+
+        xml += mergedRowBefore (rowHeights[0], paragraphBefore (s.brand, "TagBrand"), 4);
+        xml += mergedRowBefore (rowHeights[1], paragraphBefore (s.category, "TagCategoryGender"), 4);
+        xml += mergedRowBefore (rowHeights[2], paragraphBefore ("Страна: " + s.brandCountry, "TagBrandCountry"), 4);
+        xml += mergedRowBefore (rowHeights[3], paragraphBefore ("Место: " + s.manufacturingPlace, "TagManufacturingPlace"), 4);
+        xml += twoCellRowBefore (rowHeights[4], paragraphBefore ("Матер-л:", "TagMaterialLabel"),
+                                 paragraphBefore (s.material, "TagMaterialValue"), false, false, 4);
+        xml += twoCellRowBefore (rowHeights[5], paragraphBefore ("Артикул:", "TagArticleLabel"),
+                                 paragraphBefore (s.article, "TagArticleValue"), false, false, 2);
+        xml += twoCellRowBefore (rowHeights[6], paragraphBefore (s.price, "TagPriceOld"),
+                                 paragraphBefore (s.price2 + " =", "TagPriceRight"), true, true, 0);
+        xml += twoCellRowBefore (rowHeights[7], paragraphBefore ("Поставщик:", "TagSupplierLabel"),
+                                 paragraphBefore (s.supplier, "TagSupplierValue"), false, false, 2);
+        xml += mergedRowBefore (rowHeights[8], paragraphBefore (s.address1, "TagAddress"), 2);
+        xml += mergedRowBefore (rowHeights[9], paragraphBefore (s.address2, "TagAddress"), 2);
+        xml += "</w:tbl>";
+
+
+        return xml.toUtf8 ();
+    }
+
+
+    // ============================================== After: XmlByteBuilder ==============================================
+
+    void paragraphAfter (XmlByteBuilder &out, const QString &text, const char *styleId)
+    {
+        out << "<w:p><w:pPr><w:pStyle w:val=\"" << styleId << "\"/></w:pPr><w:r><w:t xml:space=\"preserve\">";
+        out.text (text) << "</w:t></w:r></w:p>";
+    }
+
+    void mergedRowAfter (XmlByteBuilder &out, int heightTwips, const QString &text, const char *styleId, int borderSz)
+    {
+        out << "<w:tr><w:trPr><w:cantSplit/><w:trHeight w:val=\"" << heightTwips << "\" w:hRule=\"exact\"/></w:trPr>"
+            << "<w:tc><w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/><w:gridSpan w:val=\"4\"/>";
+
+        if (borderSz > 0)
+            out << "<w:tcBorders><w:top w:val=\"single\" w:sz=\"" << borderSz << "\"/><w:bottom w:val=\"single\" w:sz=\"" << borderSz
+                << "\"/></w:tcBorders>";
+
+        out << "</w:tcPr>";
+        paragraphAfter (out, text, styleId);
+        out << "</w:tc></w:tr>";
+    }
+
+    void twoCellRowAfter (XmlByteBuilder &out, int heightTwips, const QString &leftText, const char *leftStyleId, const QString &rightText,
+                          const char *rightStyleId, bool diagonalBL2TR, bool rightThickBorder, int borderSz)
+    {
+        out << "<w:tr><w:trPr><w:cantSplit/><w:trHeight w:val=\"" << heightTwips << "\" w:hRule=\"exact\"/></w:trPr>";
+
+        out << "<w:tc><w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/>";
+
+        if (diagonalBL2TR || borderSz > 0)
+        {
+            out << "<w:tcBorders>";
+
+            if (diagonalBL2TR)
+                out << "<w:tr2bl w:val=\"single\" w:sz=\"8\"/>";
+
+            if (borderSz > 0)
+                out << "<w:top w:val=\"single\" w:sz=\"" << borderSz << "\"/><w:bottom w:val=\"single\" w:sz=\"" << borderSz << "\"/>";
+
+            out << "</w:tcBorders>";
+        }
+
+        out << "</w:tcPr>";
+        paragraphAfter (out, leftText, leftStyleId);
+        out << "</w:tc>";
+
+
+        out << "<w:tc><w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/><w:gridSpan w:val=\"3\"/>";
+
+        if (rightThickBorder)
+            out << "<w:tcBorders><w:top w:val=\"single\" w:sz=\"12\"/><w:left w:val=\"single\" w:sz=\"12\"/>"
+                   "<w:bottom w:val=\"single\" w:sz=\"12\"/><w:right w:val=\"single\" w:sz=\"12\"/></w:tcBorders>";
+        else if (borderSz > 0)
+            out << "<w:tcBorders><w:top w:val=\"single\" w:sz=\"" << borderSz << "\"/><w:bottom w:val=\"single\" w:sz=\"" << borderSz
+                << "\"/></w:tcBorders>";
+
+        out << "</w:tcPr>";
+        paragraphAfter (out, rightText, rightStyleId);
+        out << "</w:tc></w:tr>";
+    }
+
+    void tagAfter (XmlByteBuilder &out, const Sample &s)
+    {
+        out << "<w:tbl><w:tblPr><w:tblW w:w=\"" << 3000 << "\" w:type=\"dxa\"/><w:tblLayout w:type=\"fixed\"/>";
+        out << "</w:tblPr><w:tblGrid>";
+
+        for (int width : columnWidths)
+            out << "<w:gridCol w:w=\"" << width << "\"/>";
+        out << "</w:tblGrid>";
+
+        mergedRowAfter (out, rowHeights[0], s.brand, "TagBrand", 4);
+        mergedRowAfter (out, rowHeights[1], s.category, "TagCategoryGender", 4);
+        mergedRowAfter (out, rowHeights[2], "Страна: " + s.brandCountry, "TagBrandCountry", 4);
+        mergedRowAfter (out, rowHeights[3], "Место: " + s.manufacturingPlace, "TagManufacturingPlace", 4);
+        twoCellRowAfter (out, rowHeights[4], "Матер-л:", "TagMaterialLabel", s.material, "TagMaterialValue", false, false, 4);
+        twoCellRowAfter (out, rowHeights[5], "Артикул:", "TagArticleLabel", s.article, "TagArticleValue", false, false, 2);
+        twoCellRowAfter (out, rowHeights[6], s.price, "TagPriceOld", s.price2 + " =", "TagPriceRight", true, true, 0);
+        twoCellRowAfter (out, rowHeights[7], "Поставщик:", "TagSupplierLabel", s.supplier, "TagSupplierValue", false, false, 2);
+        mergedRowAfter (out, rowHeights[8], s.address1, "TagAddress", 2);
+        mergedRowAfter (out, rowHeights[9], s.address2, "TagAddress", 2);
+        out << "</w:tbl>";
+    }
+
+
+    // Varied values so neither side benefits from repeating the same strings; one in 16 carries markup to escape
+    QVector<Sample> makeSamples (int count)
+    {
+        const QStringList brands	= {"Zarina", "Loft & Co", "Gloria Jeans", "O'Stin", "Befree", "Sela", "Incity", "Love Republic"};
+        const QStringList categories = {"Платье", "Джинсы", "Куртка", "Рубашка", "Юбка", "Свитер"};
+
+        QVector<Sample> samples;
+        samples.reserve (count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            Sample s;
+
+            s.brand				 = brands.at (i % brands.size ()) + (i % 16 == 0 ? " <new>" : "");
+            s.category			 = categories.at (i % categories.size ()) + " жен. " + QString::number (40 + i % 12);
+            s.brandCountry		 = "Россия";
+            s.manufacturingPlace = i % 3 ? "Китай" : "Турция";
+            s.material			 = "Хлопок " + QString::number (50 + i % 50) + "%, полиэстер";
+            s.article			 = "ART-" + QString::number (100000 + i);
+            s.supplier			 = "ООО \"Торговый дом " + QString::number (i % 40) + "\"";
+            s.address1			 = "г. Москва, ул. Тверская, д. " + QString::number (1 + i % 90);
+            s.address2			 = "ТЦ \"Галерея\", 2 этаж";
+            s.price				 = QString::number (1000 + i % 9000);
+            s.price2			 = QString::number (900 + i % 8000);
+
+            samples.append (s);
+        }
+
+
+        return samples;
+    }
+} // namespace
+
+
+int main (int argc, char *argv[])
+{
+    const int tagCount = argc > 1 ? qMax (1, QByteArray (argv[1]).toInt ()) : 100000;
+
+    const QVector<Sample> samples = makeSamples (tagCount);
+
+
+    // Correctness first: the builder must not change a single byte
+    for (int i = 0; i < qMin (tagCount, 64); ++i)
+    {
+        XmlByteBuilder out;
+        tagAfter (out, samples.at (i));
+
+        if (out.data () != tagBefore (samples.at (i)))
+        {
+            std::fprintf (stderr, "Output differs for tag %d\n", i);
+
+            return 1;
+        }
+    }
+
+
+    // Each tag ends as its own byte array in both runs, as renderTag returns it
+    QElapsedTimer timer;
+    qint64 beforeBytes = 0;
+    qint64 afterBytes  = 0;
+
+    timer.start ();
+
+    for (const Sample &s : samples)
+        beforeBytes += tagBefore (s).size ();
+
+    const qint64 beforeNs = timer.nsecsElapsed ();
+
+    timer.restart ();
+
+    for (const Sample &s : samples)
+    {
+        XmlByteBuilder out (4 * 1024);
+
+        tagAfter (out, s);
+        afterBytes += out.take ().size ();
+    }
+
+    const qint64 afterNs = timer.nsecsElapsed ();
+
+    if (beforeBytes != afterBytes)
+    {
+        std::fprintf (stderr, "Output sizes differ\n");
+
+        return 1;
+    }
+
+
+    std::printf ("%d tags, identical output\n", tagCount);
+    std::printf ("before (QString::arg): %8.0f ns/tag\n", double (beforeNs) / tagCount);
+    std::printf ("after (XmlByteBuilder): %7.0f ns/tag\n", double (afterNs) / tagCount);
+    std::printf ("speedup: %.2fx\n", double (beforeNs) / double (qMax<qint64> (1, afterNs)));
+
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Forward declarations
+class PriceTag;
+class QByteArray;
+class QString;
+template <typename T> class QList;
+
+
+// On-disk cache of parsed price lists, stored next to the template config file.
+// Entries are keyed by file content hash + parser version + sheet scope, so an edited file or a parser change never hits.
+class PriceListCache
+{
+public:
+    static QString cacheDirPath ();
+
+    // Empty key for empty content
+    static QString cacheKey (const QByteArray &fileContent, int parserVersion, const QString &sheetScope);
+
+    static bool load (const QString &key, QList<PriceTag> &outTags);
+    static bool store (const QString &key, const QList<PriceTag> &tags);
+
+    // Drops least recently used entries until the cache fits into maxBytes
+    static void evict (qint64 maxBytes);
+
+    static constexpr qint64 defaultMaxBytes = 64 * 1024 * 1024;
+};
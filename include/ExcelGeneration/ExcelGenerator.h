@@ -6,6 +6,7 @@
 
 // Forward declarations
 class PriceTag;
+class PriceTagTable;
 class QString;
 template <typename T> class QList;
 
@@ -35,6 +36,7 @@ public:
 
 
     bool generateExcelDocument (const QList<PriceTag> &priceTags, const QString &outputPath);
+    bool generateExcelDocument (const PriceTagTable &priceTags, const QString &outputPath);
 
     ExcelLayoutConfig layout () const { return layoutConfig; }
 
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "SheetRowSource.h"
+
+
+// CSV/TSV export read as rows for the same header detection and row parsing as xlsx sheets.
+// The file is memory-mapped; delimiters, quotes and line ends are located with an SSE2 scan where available.
+// Encoding is UTF-8 (with or without BOM) or, when the bytes are not valid UTF-8, CP1251.
+class CsvRowSource: public SheetRowSource
+{
+public:
+    // delimiter 0 = detect from the first line (';', ',' or tab)
+    explicit CsvRowSource (const QString &filePath, char delimiter = 0);
+    ~CsvRowSource () override;
+
+    bool open () override;
+    bool nextRow (SheetRow &row) override;
+    int estimatedRows () const override { return rowEstimate; }
+    void setWantedColumns (const QVector<int> &columns) override;
+
+    char delimiter () const { return separator; }
+    bool isUtf8 () const { return utf8; }
+
+
+private:
+    QFile file;
+    QByteArray loadedData; // used only when the file cannot be mapped
+    const char *bytes = nullptr;
+    qint64 size		  = 0;
+
+    qint64 dataStart = 0; // past the BOM
+    qint64 pos		 = 0;
+    int rowIndex	 = 0;
+    int rowEstimate	 = 0;
+
+    char separator = 0;
+    bool utf8	   = true;
+
+    QVector<bool> wanted; // by 1-based column; empty = every column
+
+
+    bool mapFile ();
+    void detectFormat ();
+
+    QString decodeField (const char *begin, const char *end, bool hasEscapedQuotes) const;
+};
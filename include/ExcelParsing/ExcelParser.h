@@ -1,16 +1,25 @@
 #pragma once
 
+#include <QFutureWatcher>
+#include <QList>
 #include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
 
 // QXlsx includes - needed for method signatures
 #include "xlsxcellrange.h"
 #include "xlsxdocument.h"
 
+#include "HeaderDictionary.h"
+#include "SheetRowSource.h"
+#include "pricetag.h"
+
 // Forward declarations
-class PriceTag;
+class StringPool;
+class XlsxZipArchive;
 class QString;
-template <typename T> class QList;
-template <typename K, typename V> class QMap;
 
 
 class ExcelParser: public QObject
@@ -20,12 +29,64 @@ class ExcelParser: public QObject
 
 public:
     explicit ExcelParser (QObject *parent = nullptr);
-    ~ExcelParser ();
+    ~ExcelParser () override;
+
+    // Bump whenever the same file would parse into different tags (cached results are keyed by it)
+    static constexpr int parserVersion = 1;
 
     bool parseExcelFile (const QString &filePath, QList<PriceTag> &priceTags);
 
+    // .csv/.tsv exports go through the delimited text reader, everything else through parseExcelFile
+    bool parseFile (const QString &filePath, QList<PriceTag> &priceTags);
+
+    // Tags are handed to the sink in file order as they are parsed and not collected (no cache either).
+    // Sheets are read one after another; a sink returning false stops the parse, which then fails.
+    using TagSink = std::function<bool (const PriceTag &)>;
+    bool parseFileStreaming (const QString &filePath, const TagSink &sink);
+    static bool isSupportedFile (const QString &filePath);
+
+    // Runs parseFile on a pool thread; progress and the result arrive as signals. False if a parse is already running.
+    bool parseAsync (const QString &filePath);
+
+    // Cooperative: the running parse stops at the next row and finishes with success = false
+    void cancel ();
+
+    bool isParsing () const;
+    bool isCancelled () const { return cancelRequested; }
+
+    // Sheet scope: the active sheet by default, every worksheet, or the named subset (takes precedence)
+    void setParseAllSheets (bool enabled);
+    void setSelectedSheets (const QStringList &sheetNames);
+
+
+signals:
+    void progressChanged (qint64 rowsProcessed, qint64 estimatedRows);
+    void parsingFinished (const QString &filePath, bool success, const QList<PriceTag> &priceTags);
+
 
 private:
+    struct AsyncResult
+    {
+        QString filePath;
+        bool success = false;
+        QList<PriceTag> priceTags;
+    };
+
+
+    bool parseAllSheets = false;
+    QStringList selectedSheets;
+
+    QFutureWatcher<AsyncResult> *asyncWatcher = nullptr;
+
+    // Shared by the sheet workers of one parse
+    std::atomic<bool> cancelRequested{false};
+    std::atomic<qint64> rowsProcessed{0};
+    std::atomic<qint64> rowsEstimated{0};
+
+    TagSink tagSink;
+    qint64 streamedTags = 0;
+
+
     struct ColumnMapping
     {
         int nameColumn				 = -1;
@@ -46,45 +107,55 @@ private:
 
 
     // Helpers for parseDataRow splitting
-    bool readTrimmedStringFromCell (QXlsx::Document *xlsx, int row, int col, QString &out) const;
-    bool readPositiveDoubleFromCell (QXlsx::Document *xlsx, int row, int col, double &out) const;
+    bool readTrimmedStringFromCell (const SheetRow &row, int col, QString &out) const;
+    bool readPositiveDoubleFromCell (const SheetRow &row, int col, double &out) const;
+
 
+    bool parseDataRow (const SheetRow &row, const ColumnMapping &mapping, StringPool &pool, QString &currentSupplier,
+                       QString &currentAddress, PriceTag &priceTag) const;
 
-    bool parseDataRow (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, QString &currentSupplier, QString &currentAddress,
-                       PriceTag &priceTag) const;
+    void parseAllRows (SheetRowSource &source, const ColumnMapping &mapping, QList<PriceTag> &priceTags);
 
-    void parseAllRows (QXlsx::Document &xlsx, const QXlsx::CellRange &range, const ColumnMapping &mapping,
-                       QList<PriceTag> &priceTags) const;
+    bool parseBrand (const SheetRow &row, const ColumnMapping &mapping, StringPool &pool, PriceTag &priceTag) const;
+    bool parsePrice (const SheetRow &row, const ColumnMapping &mapping, PriceTag &priceTag) const;
+    void parseQuantity (const SheetRow &row, const ColumnMapping &mapping, PriceTag &priceTag) const;
+    void parseAttributes (const SheetRow &row, const ColumnMapping &mapping, StringPool &pool, PriceTag &priceTag) const;
 
-    bool parseBrand (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, PriceTag &priceTag) const;
-    bool parsePrice (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, PriceTag &priceTag) const;
-    void parseQuantity (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, PriceTag &priceTag) const;
-    void parseAttributes (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, PriceTag &priceTag) const;
 
+    bool findHeaders (SheetRowSource &source, ColumnMapping &mapping);
 
-    bool findHeaders (QXlsx::Document *xlsx, const QXlsx::CellRange &range, ColumnMapping &mapping);
-    int findMaxDataRow (QXlsx::Document *xlsx, const QXlsx::CellRange &range, const ColumnMapping &mapping) const;
+    // nextRow with progress accounting; false once cancellation is requested
+    bool readNextRow (SheetRowSource &source, SheetRow &row);
 
 
     bool readAndValidateDimension (QXlsx::Document &xlsx, QXlsx::CellRange &outRange) const;
 
 
-    void updateSupplierAndAddress (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, QString &currentSupplier,
+    void updateSupplierAndAddress (const SheetRow &row, const ColumnMapping &mapping, StringPool &pool, QString &currentSupplier,
                                    QString &currentAddress, PriceTag &priceTag) const;
 
 
     bool validatePriceTag (const PriceTag &priceTag) const;
 
-    QString normalizeText (const QString &text);
+    QString normalizeText (const QString &text) const;
 
 
     // Helpers for findHeaders splitting
     void resetColumnMapping (ColumnMapping &mapping) const;
-    QMap<QString, int *> buildHeaderColumnMap (ColumnMapping &mapping) const;
-    void tryAssignHeaderMatch (const QString &normalizedCellText, int col, const QMap<QString, int *> &columnMap) const;
+    int *columnSlot (ColumnMapping &mapping, HeaderDictionary::Column column) const;
+    bool tryAssignHeaderMatch (HeaderDictionary::Column column, int col, ColumnMapping &mapping) const;
 
 
     // Helpers for parseExcelFile splitting
-    bool quickZipSignatureCheck (const QString &filePath) const;
-    bool preScanZipForWorkbookAndSheets (const QString &filePath) const;
+    bool quickZipSignatureCheck (const XlsxZipArchive &archive) const;
+    bool preScanZipForWorkbookAndSheets (const XlsxZipArchive &archive) const;
+
+    QString sheetScopeKey () const;
+    QVector<int> resolveSheetIndices (const QStringList &sheetNames, int activeIndex) const;
+
+    bool parseRowSource (SheetRowSource &source, QList<PriceTag> &priceTags);
+    bool parseDelimitedTextFile (const QString &filePath, QList<PriceTag> &priceTags);
+    QVector<int> mappedColumns (ColumnMapping &mapping) const;
+    bool parseWithStreamingReader (const XlsxZipArchive &archive, QList<PriceTag> &priceTags, bool &handled);
+    bool parseWithDocument (const XlsxZipArchive &archive, QList<PriceTag> &priceTags);
 };
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+
+// Known price list column headers (with alternate spellings and English aliases) in a perfect-hash table.
+// Built once on first use; a lookup is one hash of the cell text plus at most one key comparison.
+class HeaderDictionary
+{
+public:
+    enum Column
+    {
+        Supplier,
+        Address,
+        Name,
+        Category,
+        AdditionalData,
+        Gender,
+        BrandCountry,
+        ManufacturingPlace,
+        Material,
+        Size,
+        Article,
+        Price,
+        Price2,
+        Quantity,
+
+        ColumnCount,
+        Unknown = ColumnCount
+    };
+
+
+    static const HeaderDictionary &instance ();
+
+    // Text must already be normalized (trimmed, single spaces); case is ignored
+    Column lookup (QStringView text) const;
+
+
+private:
+    struct Entry
+    {
+        QString key; // case-folded
+        Column column = Unknown;
+    };
+
+
+    QVector<Entry> table;
+    quint32 seed	  = 0;
+    quint32 mask	  = 0;
+    int maxKeyLength = 0;
+
+
+    HeaderDictionary ();
+
+    bool tryBuild (const QVector<Entry> &keys, int tableSize, quint32 candidateSeed);
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QStringView>
+#include <QVariant>
+
+
+// Price cell parsing without temporary strings: typed numeric cells are read as is, text is scanned in place.
+// Understands "1 234,50 руб.", "1.234,50", "1,234.50", "$12.99", NBSP / narrow NBSP grouping and decimal commas.
+namespace NumericScanner
+{
+    // Any number found in the text, sign ignored; false when the text has no digits
+    bool scanNumber (QStringView text, double &out);
+
+    // Strictly positive value of a cell; false for empty, zero and non-numeric cells
+    bool readPositive (const QVariant &value, double &out);
+} // namespace NumericScanner
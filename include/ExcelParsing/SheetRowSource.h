@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QVariant>
+#include <QVector>
+
+
+// One worksheet row as seen by the parser: cell values indexed by 1-based column, index 0 is unused
+struct SheetRow
+{
+    int rowIndex = 0;
+    QVector<QVariant> cells;
+
+
+    const QVariant &cell (int col) const
+    {
+        static const QVariant empty;
+
+        return (col > 0 && col < cells.size ()) ? cells.at (col) : empty;
+    }
+};
+
+
+// Sequential row provider the parser walks instead of addressing a whole in-memory document
+class SheetRowSource
+{
+public:
+    virtual ~SheetRowSource () = default;
+
+    // Positions the source before the first row; may be called again to restart
+    virtual bool open () = 0;
+
+    // Fills the next non-empty row, returns false at the end of the sheet
+    virtual bool nextRow (SheetRow &row) = 0;
+
+    // Row count announced by the sheet itself (dimension), 0 when unknown; only used for progress
+    virtual int estimatedRows () const { return 0; }
+
+    // Hint given once the header row is known: only these 1-based columns will be read, the rest may be skipped
+    virtual void setWantedColumns (const QVector<int> &columns) { Q_UNUSED (columns); }
+};
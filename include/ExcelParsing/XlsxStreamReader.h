@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QHash>
+#include <QScopedPointer>
+#include <QString>
+#include <QVector>
+
+#include "SheetRowSource.h"
+#include "XlsxZipArchive.h"
+
+// Forward declarations
+class QIODevice;
+class QXmlStreamReader;
+
+
+// Workbook-level parts read straight from the package: sheet list, active tab and the shared string table.
+// The archive is borrowed and must outlive the workbook and its sheet readers.
+class XlsxStreamWorkbook
+{
+public:
+    explicit XlsxStreamWorkbook (const XlsxZipArchive &archive);
+
+    bool load ();
+
+    int sheetCount () const { return sheets.size (); }
+    int activeSheetIndex () const { return activeSheet; }
+
+    QString sheetName (int index) const;
+    QString sheetPath (int index) const;
+
+    const XlsxZipArchive &archive () const { return zip; }
+    const QVector<QString> &sharedStrings () const { return strings; }
+
+
+private:
+    struct SheetEntry
+    {
+        QString name;
+        QString path; // empty for chartsheets and other non-worksheet parts
+    };
+
+
+    const XlsxZipArchive &zip;
+    QVector<SheetEntry> sheets;
+    QVector<QString> strings;
+    int activeSheet = 0;
+
+
+    QHash<QString, QString> readWorkbookRelationships (QString &sharedStringsPath) const;
+    bool readWorkbook (const QHash<QString, QString> &worksheetTargets);
+    bool readSharedStrings (const QString &path);
+};
+
+
+// Pull-parses one worksheet part and yields its rows one by one; memory does not grow with the row count
+class XlsxSheetReader: public SheetRowSource
+{
+public:
+    XlsxSheetReader (const XlsxStreamWorkbook &workbook, int sheetIndex);
+    ~XlsxSheetReader () override;
+
+    bool open () override;
+    bool nextRow (SheetRow &row) override;
+    int estimatedRows () const override { return dimensionRows; }
+
+
+private:
+    enum class CellType
+    {
+        Number,
+        SharedString,
+        InlineString,
+        String,
+        Boolean
+    };
+
+
+    const XlsxStreamWorkbook &workbook;
+    const int sheetIndex;
+
+    QScopedPointer<QIODevice> device;
+    QScopedPointer<QXmlStreamReader> xml; // declared after the device it reads from, so it is destroyed first
+
+    int lastRowIndex  = 0;
+    int dimensionRows = 0;
+
+
+    bool readRow (SheetRow &row);
+    QVariant readCellValue (CellType type);
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+// Forward declarations
+class QIODevice;
+
+
+// Read-only view of an xlsx (ZIP) package. The file is opened and memory-mapped once (read whole if mapping
+// is not possible), the central directory is parsed once, and the same handle then serves validation,
+// hashing, the workbook parts and the worksheet streams. Entries inflate on demand straight from the mapping.
+class XlsxZipArchive
+{
+public:
+    explicit XlsxZipArchive (const QString &filePath);
+    ~XlsxZipArchive ();
+
+    // File could be read (mapped or loaded)
+    bool isOpen () const { return bytes != nullptr; }
+
+    // Central directory parsed; entries can be opened
+    bool isValid () const { return valid; }
+
+    QString fileName () const { return file.fileName (); }
+
+    // Whole file without a copy; must not outlive the archive
+    QByteArray rawData () const;
+
+    bool hasZipSignature () const;
+
+    QStringList filePaths () const { return paths; }
+    bool contains (const QString &path) const { return entries.contains (path); }
+
+    // Whole entry at once - meant for small parts like workbook.xml and relationships
+    QByteArray fileData (const QString &path) const;
+
+    // Device is already opened for reading and owned by the caller; nullptr if the entry is missing.
+    // Safe to call from several threads: devices only read the shared mapping.
+    QIODevice *openEntry (const QString &path) const;
+
+
+private:
+    struct Entry
+    {
+        quint16 method			  = 0;
+        quint32 compressedSize	  = 0;
+        quint32 uncompressedSize  = 0;
+        quint32 localHeaderOffset = 0;
+    };
+
+
+    QFile file;
+    QByteArray loadedData; // used only when the file cannot be mapped
+    const char *bytes = nullptr;
+    qint64 size		  = 0;
+
+    QHash<QString, Entry> entries;
+    QStringList paths;
+    bool valid = false;
+
+
+    bool mapFile ();
+    bool readCentralDirectory ();
+
+    Q_DISABLE_COPY (XlsxZipArchive)
+};
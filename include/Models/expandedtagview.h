@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QVector>
+
+#include "pricetagtable.h"
+
+
+// Physical tags of a table (each row repeated by its quantity) addressed without copying rows:
+// only the running copy counts are stored, and any position maps back to (row, copy) by binary search.
+class ExpandedTagView
+{
+public:
+    struct Slot
+    {
+        int row	 = 0;
+        int copy = 0; // 0-based copy of the row
+    };
+
+
+    // The table must outlive the view; quantities below 1 count as one tag
+    explicit ExpandedTagView (const PriceTagTable &table);
+
+    const PriceTagTable &table () const { return source; }
+
+    qint64 size () const { return rowEnds.isEmpty () ? 0 : rowEnds.last (); }
+    bool isEmpty () const { return size () == 0; }
+
+    // O(log rows); index must be in [0, size ())
+    Slot slot (qint64 index) const;
+
+    // Position of the first copy of a row
+    qint64 firstIndex (int row) const { return row > 0 ? rowEnds.at (row - 1) : 0; }
+
+
+private:
+    const PriceTagTable &source;
+    QVector<qint64> rowEnds; // rowEnds[row] = tags in rows 0..row
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+
+// Amount in minor units (kopecks). Prices are converted once when the list is parsed, and every writer
+// prints them through format (), so DOCX and XLSX show the same text for the same tag.
+class Money
+{
+public:
+    // Longest output: sign, 19 digits, 6 group separators, comma and two decimals
+    static constexpr int maxFormattedLength = 32;
+
+    constexpr Money () = default;
+
+    static constexpr Money fromMinorUnits (qint64 units) { return Money (units); }
+
+    // Rounds to the nearest kopeck; NaN and infinities become zero
+    static Money fromDouble (double value);
+
+    constexpr qint64 minorUnits () const { return units; }
+    double toDouble () const { return double (units) / 100.0; }
+
+    constexpr bool isPositive () const { return units > 0; }
+
+    constexpr bool operator== (Money other) const { return units == other.units; }
+    constexpr bool operator!= (Money other) const { return units != other.units; }
+    constexpr bool operator< (Money other) const { return units < other.units; }
+    constexpr bool operator> (Money other) const { return units > other.units; }
+
+
+    // Writes into out (maxFormattedLength chars) and returns the length; no allocation.
+    // Whole amounts print without decimals ("1200"), others with a comma ("1200,50");
+    // grouping separates thousands with a no-break space ("1 200").
+    int format (QChar *out, bool thousandsGrouping = false) const;
+
+    QString toString (bool thousandsGrouping = false) const;
+
+
+private:
+    qint64 units = 0;
+
+    constexpr explicit Money (qint64 units) : units (units) {}
+};
@@ -2,6 +2,8 @@
 
 #include <QString>
 
+#include "money.h"
+
 
 class PriceTag
 {
@@ -10,56 +12,60 @@ public:
     PriceTag (const QString &name, const QString &description, double price, int quantity);
 
 
-    // Filling main fields:
-    QString getName () const;
+    // Filling main fields (text getters return references to the stored values - no copy, no refcount traffic):
+    const QString &getName () const;
     void setName (const QString &name);
 
-    QString getDescription () const;
+    const QString &getDescription () const;
     void setDescription (const QString &description);
 
     double getPrice () const;
     void setPrice (double price);
+    Money getPriceMoney () const;
+    void setPrice (Money price);
 
     int getQuantity () const;
     void setQuantity (int quantity);
 
-    QString getSupplier () const;
+    const QString &getSupplier () const;
     void setSupplier (const QString &supplier);
 
-    QString getAddress () const;
+    const QString &getAddress () const;
     void setAddress (const QString &address);
 
-    QString getBrand () const;
+    const QString &getBrand () const;
     void setBrand (const QString &brand);
 
-    QString getCategory () const;
+    const QString &getCategory () const;
     void setCategory (const QString &category);
 
-    QString getAdditionalData () const;
+    const QString &getAdditionalData () const;
     void setAdditionalData (const QString &data);
 
-    QString getGender () const;
+    const QString &getGender () const;
     void setGender (const QString &gender);
 
-    QString getBrandCountry () const;
+    const QString &getBrandCountry () const;
     void setBrandCountry (const QString &country);
 
-    QString getManufacturingPlace () const;
+    const QString &getManufacturingPlace () const;
     void setManufacturingPlace (const QString &place);
 
-    QString getMaterial () const;
+    const QString &getMaterial () const;
     void setMaterial (const QString &material);
 
-    QString getSize () const;
+    const QString &getSize () const;
     void setSize (const QString &size);
 
-    QString getArticle () const;
+    const QString &getArticle () const;
     void setArticle (const QString &article);
 
     double getPrice2 () const;
     void setPrice2 (double price);
+    Money getPrice2Money () const;
+    void setPrice2 (Money price);
 
-    QString getAdditionalData2 () const;
+    const QString &getAdditionalData2 () const;
     void setAdditionalData2 (const QString &data);
 
 
@@ -74,8 +80,6 @@ public:
 private:
     QString name;
     QString description;
-    double price;
-    int quantity;
     QString supplier;
     QString address;
     QString brand;
@@ -87,6 +91,11 @@ private:
     QString material;
     QString size;
     QString article;
-    double price2;
     QString additionalData2;
+
+    // Numbers kept together after the strings: no padding between them, one cache line for price checks.
+    // Prices are fixed-point kopecks, rounded once when set from a double
+    Money price;
+    Money price2;
+    int quantity = 0;
 };
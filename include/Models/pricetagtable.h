@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "pricetag.h"
+
+
+// Difference between a table and a re-parse of the same file: unchanged rows are kept by index, only new content is carried
+struct PriceTagDelta
+{
+    QVector<int> sourceRows; // per row of the updated table: kept row of the old table, or -1 for the next of addedTags
+    QList<PriceTag> addedTags;
+    QVector<int> removedRows; // old rows with no counterpart, ascending
+    bool reordered = false;
+
+    bool isEmpty () const { return addedTags.isEmpty () && removedRows.isEmpty () && ! reordered; }
+};
+
+
+// Column-wise storage of a price list: one contiguous array per field.
+// Text columns hold ids into a single string arena shared by all of them (id 0 is the empty string),
+// so scans that group or filter by brand, category or supplier compare integers and touch only their column.
+class PriceTagTable
+{
+public:
+    enum TextColumn
+    {
+        Name,
+        Description,
+        Supplier,
+        Address,
+        Brand,
+        Category,
+        AdditionalData,
+        Gender,
+        BrandCountry,
+        ManufacturingPlace,
+        Material,
+        Size,
+        Article,
+        AdditionalData2,
+        TextColumnCount
+    };
+
+
+    PriceTagTable ();
+
+    static PriceTagTable fromList (const QList<PriceTag> &priceTags);
+    QList<PriceTag> toList () const;
+
+    int size () const { return quantityColumn.size (); }
+    bool isEmpty () const { return quantityColumn.isEmpty (); }
+
+    void reserve (int rows);
+    void clear ();
+
+    void append (const PriceTag &priceTag);
+
+    // Builds a PriceTag for one row; the strings are shared with the arena, not copied
+    PriceTag at (int row) const;
+
+    // Rows are matched by content hash; equal rows keep their place in the arena and are not re-interned
+    PriceTagDelta diff (const QList<PriceTag> &updated) const;
+    void applyDelta (const PriceTagDelta &delta);
+
+    static quint64 contentHash (const PriceTag &priceTag);
+
+    // Field-by-field check behind a hash match; equal strings share an arena id, so this compares integers
+    bool sameContent (int row, int other) const;
+
+
+    // Column access:
+    const QVector<quint32> &textColumn (TextColumn column) const { return textColumns[column]; }
+    const QString &text (TextColumn column, int row) const { return strings.at (int (textColumns[column].at (row))); }
+
+    const QVector<Money> &prices () const { return priceColumn; }
+    const QVector<Money> &prices2 () const { return price2Column; }
+    const QVector<int> &quantities () const { return quantityColumn; }
+    const QVector<quint64> &rowHashes () const { return hashColumn; }
+
+
+    // String arena:
+    const QString &string (quint32 id) const { return strings.at (int (id)); }
+    int stringCount () const { return strings.size (); }
+
+
+private:
+    QVector<quint32> textColumns[TextColumnCount];
+
+    QVector<Money> priceColumn;
+    QVector<Money> price2Column;
+    QVector<int> quantityColumn;
+    QVector<quint64> hashColumn;
+
+    QVector<QString> strings;
+    QHash<QString, quint32> stringIds;
+
+
+    quint32 internString (const QString &value);
+    void appendRow (const PriceTagTable &source, int row);
+    void compactStrings ();
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QSet>
+#include <QString>
+
+
+// Interning pool for values that repeat across price list rows (supplier, address, brand, category...).
+// Equal values come back as copies of one pooled QString, so every tag shares a single allocation per value.
+class StringPool
+{
+public:
+    QString intern (const QString &value);
+
+    int size () const { return pool.size (); }
+    void clear () { pool.clear (); }
+
+
+private:
+    QSet<QString> pool;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QWaitCondition>
+
+#include <utility>
+
+
+// Blocking producer/consumer queue with a fixed capacity: a fast producer waits for the consumer
+// instead of growing memory. Either side can end the exchange: close () lets the consumer drain what
+// is queued, abort () wakes both sides and drops the rest.
+template <typename T> class BoundedQueue
+{
+public:
+    explicit BoundedQueue (int capacity) : capacity (qMax (1, capacity)) {}
+
+
+    // Blocks while full; false once the queue is closed or aborted
+    bool push (T value)
+    {
+        QMutexLocker locker (&mutex);
+
+        while (items.size () >= capacity && ! closed)
+            notFull.wait (&mutex);
+
+        if (closed)
+            return false;
+
+        items.enqueue (std::move (value));
+        notEmpty.wakeOne ();
+
+
+        return true;
+    }
+
+    // Blocks while empty; false when closed and drained, or aborted
+    bool pop (T &value)
+    {
+        QMutexLocker locker (&mutex);
+
+        while (items.isEmpty () && ! closed)
+            notEmpty.wait (&mutex);
+
+        if (items.isEmpty ())
+            return false;
+
+        value = items.dequeue ();
+        notFull.wakeOne ();
+
+
+        return true;
+    }
+
+    // Producer is done; queued items can still be popped
+    void close ()
+    {
+        QMutexLocker locker (&mutex);
+
+        closed = true;
+
+        notEmpty.wakeAll ();
+        notFull.wakeAll ();
+    }
+
+    // Consumer gave up; producer's next push fails
+    void abort ()
+    {
+        QMutexLocker locker (&mutex);
+
+        closed = true;
+        items.clear ();
+
+        notEmpty.wakeAll ();
+        notFull.wakeAll ();
+    }
+
+
+private:
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+
+    QQueue<T> items;
+    const int capacity;
+    bool closed = false;
+
+    Q_DISABLE_COPY (BoundedQueue)
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+
+// Forward declarations
+class WordGenerator;
+
+
+// Price list -> DOCX without holding the list: a pool thread parses and pushes batches of tags into a
+// bounded queue, the calling thread lays them out through WordGenerator's streaming session. Peak memory
+// is the queue, one table row of XML and the compressor window, whatever the size of the input.
+class PriceTagPipeline: public QObject
+{
+    Q_OBJECT
+
+
+public:
+    PriceTagPipeline (WordGenerator &generator, bool parseAllSheets, QObject *parent = nullptr);
+
+    // Blocks until the document is written; a failed or cancelled run leaves no output file
+    bool run (const QString &inputPath, const QString &outputPath);
+
+    // Thread-safe: stops run () at the next tag, or before it starts. Never reset - use one pipeline per run
+    void cancel ();
+    bool isCancelled () const;
+
+    qint64 tagCount () const { return tagsWritten; }
+
+
+signals:
+    void progressChanged (qint64 rowsProcessed, qint64 estimatedRows);
+
+
+private:
+    WordGenerator &generator;
+    bool allSheets;
+    qint64 tagsWritten = 0;
+    std::atomic<bool> cancelRequested {false};
+};
@@ -8,11 +8,13 @@
 #include <QSettings>
 #include <QString>
 
+#include "pricetagtable.h"
 #include "tagtemplate.h"
 
 // Forward declarations
 class ExcelGenerator;
 class ExcelParser;
+class PriceTagPipeline;
 class WordGenerator;
 class TemplateEditorDialog;
 class PriceTag;
@@ -27,6 +29,9 @@ class QLabel;
 class QProgressBar;
 class QTextEdit;
 class QComboBox;
+class QCheckBox;
+class QFileSystemWatcher;
+class QTimer;
 class QDragEnterEvent;
 class QDragMoveEvent;
 class QDragLeaveEvent;
@@ -37,17 +42,19 @@ class QMimeData;
 class QIcon;
 class QHBoxLayout;
 
+template <typename T> class QFutureWatcher;
+
 
 struct StatisticsData
 {
     int totalProducts		  = 0;
     int totalTags			  = 0;
     int productsWithDiscount  = 0;
-    double totalValue		  = 0.0;
-    double totalDiscountValue = 0.0;
+    qint64 totalValue		  = 0; // kopecks: exact under the add/subtract of delta reloads
+    qint64 totalDiscountValue = 0;
     QMap<QString, int> brandCount;
     QMap<QString, int> categoryCount;
-    QSet<QString> suppliers;
+    QMap<QString, int> supplierCount;
 };
 
 
@@ -80,6 +87,12 @@ private slots:
     void generateDocument ();
     void processFile (const QString &filePath);
     void showStatistics ();
+    void onParsingProgress (qint64 rowsProcessed, qint64 estimatedRows);
+    void onParsingFinished (const QString &filePath, bool success, const QList<PriceTag> &parsed);
+    void onStreamingFinished ();
+    void onWatchedFileChanged (const QString &path);
+    void onWatchedDirectoryChanged (const QString &path);
+    void reloadCurrentFile ();
 
 
 private:
@@ -107,11 +120,25 @@ private:
     ExcelParser *excelParser;
     WordGenerator *wordGenerator;
     ExcelGenerator *excelGenerator;
-    QList<PriceTag> priceTags;
+    PriceTagTable priceTable;
+    StatisticsData statistics;
     QComboBox *outputFormatComboBox;
+    QCheckBox *allSheetsCheckBox	= nullptr;
+    QComboBox *compressionComboBox	= nullptr; // DOCX only: XLSX is packaged by QXlsx
+    QCheckBox *tablePerPageCheckBox = nullptr;
+
+    // Streaming generation runs on the pool; non-null while it is in flight
+    PriceTagPipeline *pipeline				= nullptr;
+    QFutureWatcher<bool> *pipelineWatcher	= nullptr;
+    QString pipelineOutputPath;
 
     QSettings settings;
 
+    // Auto-reload of the loaded file after it is saved elsewhere (e.g. in Excel)
+    QFileSystemWatcher *fileWatcher = nullptr;
+    QTimer *reloadTimer				= nullptr;
+    bool reloadInProgress			= false;
+
     TagTemplate currentTemplate;
 
     // Supported languages ​​"EN" or "RU"
@@ -136,10 +163,16 @@ private:
     void updateCharts ();
     void updateThemeStyles ();
     void updateButtonsPrimaryStyles ();
+    void setParsingUiState (bool parsing);
+    void setGeneratingUiState (bool generating);
 
     void toggleTheme ();
 
     void applyTemplateToGenerators (const TagTemplate &tpl);
+    void setTablePerPage (bool enabled);
+
+    void startStreamingGeneration (const QString &outPath);
+    void showGenerationResult (bool ok, const QString &outPath);
 
     QString buildPrimaryButtonStyle (bool isDark) const;
 
@@ -192,6 +225,17 @@ private:
     void updateDropVisualOnMove (const QPoint &posInDrop, QDragMoveEvent *event);
 
 
+    // Output format 2: the file is parsed straight into the DOCX writer at generation time
+    bool isStreamingOutput () const;
+    bool isExcelOutput () const;
+
+
+    // Auto-reload helpers
+    void setupFileWatcher ();
+    void watchFile (const QString &filePath);
+    void applyPriceListDelta (const QList<PriceTag> &parsed);
+
+
     // Statistics helpers
     StatisticsData aggregateStatistics () const;
     QString formatStatisticsText (const StatisticsData &data) const;
@@ -58,6 +58,8 @@ public:
     double spacingHMm	  = 5.0;
     double spacingVMm	  = 5.0;
 
+    bool priceThousandsGrouping = false; // "12 500" instead of "12500"
+
     QMap<TagField, TagTextStyle> styles;
     QMap<TagField, QString> texts;
 
@@ -71,6 +73,9 @@ public:
 
     static const QList<TagField> &allFields ();
 
+    // Stable name of a field: JSON key and DOCX style id suffix
+    static QString fieldKey (TagField field);
+
 
     // JSON de/serialization
     QJsonObject toJson () const;
@@ -72,6 +72,7 @@ private:
     QDoubleSpinBox *spinMarginB;
     QDoubleSpinBox *spinSpacingH;
     QDoubleSpinBox *spinSpacingV;
+    QCheckBox *priceGroupingCheck;
 
 
     // Group boxes and forms for relabeling
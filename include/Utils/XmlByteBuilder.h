@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include "XmlEscape.h"
+
+
+// Append-only UTF-8 buffer for generated XML: literals are copied as bytes, integers are written
+// without a format string and text goes through the shared escaper, so nothing is re-scanned or
+// allocated per piece. Reserve the expected size up front for large parts.
+class XmlByteBuilder
+{
+public:
+    explicit XmlByteBuilder (int reserveBytes = 0)
+    {
+        if (reserveBytes > 0)
+            bytes.reserve (reserveBytes);
+    }
+
+    // Markup literal (already valid UTF-8 XML)
+    XmlByteBuilder &operator<< (const char *literal)
+    {
+        bytes.append (literal);
+
+        return *this;
+    }
+
+    XmlByteBuilder &operator<< (const QByteArray &raw)
+    {
+        bytes.append (raw);
+
+        return *this;
+    }
+
+    // Decimal integer
+    XmlByteBuilder &operator<< (int value)
+    {
+        char digits[12];
+        char *p				= digits + sizeof (digits);
+        const bool negative = value < 0;
+        unsigned magnitude	= negative ? 0u - unsigned (value) : unsigned (value);
+
+        do
+        {
+            *--p = char ('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+
+        if (negative)
+            *--p = '-';
+
+        bytes.append (p, int (digits + sizeof (digits) - p));
+
+        return *this;
+    }
+
+    // Character data or attribute value: escaped and UTF-8 encoded
+    XmlByteBuilder &text (const QString &value)
+    {
+        XmlEscape::appendUtf8 (bytes, value);
+
+        return *this;
+    }
+
+    int size () const { return bytes.size (); }
+    void clear () { bytes.clear (); }
+
+    const QByteArray &data () const { return bytes; }
+    QByteArray take ()
+    {
+        QByteArray out;
+        out.swap (bytes);
+
+        return out;
+    }
+
+
+private:
+    QByteArray bytes;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+
+// XML text escaping shared by the document writers. One pass over the UTF-16 data: the five markup
+// characters become entities and control characters XML 1.0 forbids (all below U+0020 except tab, LF
+// and CR) are dropped. Runs that need no change are found 8 characters at a time with SSE2 where available.
+namespace XmlEscape
+{
+    // Escaped text encoded as UTF-8 and appended to out; unpaired surrogates are written as '?', as QString::toUtf8 does
+    void appendUtf8 (QByteArray &out, const QString &text);
+
+    // Escaped copy; the input itself (shared, no copy) when nothing needs escaping
+    QString escaped (const QString &text);
+
+    // Forbidden control characters removed, markup left alone - for writers that escape on their own (QXlsx)
+    QString sanitized (const QString &text);
+} // namespace XmlEscape
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+
+// Tag XML (UTF-8) compiled once per template into literal spans and value slots. The template is rendered
+// with slotMarker (i) in place of every per-tag value and then split at the markers, so rendering a tag
+// is a run of byte copies plus the escaped values - no formatting work per tag.
+class TagFragmentProgram
+{
+public:
+    static constexpr int maxSlots = 16;
+
+    // Placeholder for slot i in the reference rendering (private use area: never produced by the values)
+    static QChar slotMarker (int slot) { return QChar (ushort (0xE000 + slot)); }
+
+    // Each of slots 0..slotCount-1 must occur exactly once and no other marker may occur;
+    // otherwise (e.g. template text holding the same private-use characters) the program stays invalid
+    bool compile (const QByteArray &renderedXml, int slotCount);
+
+    bool isValid () const { return valid; }
+    void clear ();
+
+    // values[i] is XML-escaped and UTF-8 encoded into slot i
+    void render (QByteArray &out, const QString *values) const;
+
+
+private:
+    struct Op
+    {
+        int literalBegin  = 0;
+        int literalLength = 0;
+        int slot		  = -1; // value written after the literal; -1 for the trailing literal
+    };
+
+    QByteArray literals;
+    QVector<Op> ops;
+    bool valid = false;
+};
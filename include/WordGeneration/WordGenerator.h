@@ -1,17 +1,21 @@
 #pragma once
 
+#include <QByteArray>
+#include <QHash>
+#include <QList>
 #include <QObject>
+#include <QVector>
 
+#include "TagFragmentProgram.h"
+#include "ZipStreamWriter.h"
 #include "tagtemplate.h"
 
 // Forward declarations
+class ExpandedTagView;
 class PriceTag;
+class PriceTagTable;
 class QString;
-template <typename T> class QList;
-
-namespace QXlsx {
-class ZipWriter;
-}
+class XmlByteBuilder;
 
 
 class WordGenerator: public QObject
@@ -35,17 +39,36 @@ public:
         double marginBottomMm = 8.0;
         double spacingHMm	  = 0.0;
         double spacingVMm	  = 0.0;
+
+        // One outer table per page, separated by page breaks: Word paginates many small tables far faster
+        // than one table spanning the whole document
+        bool tablePerPage = false;
     };
 
 
     void setLayoutConfig (const DocxLayoutConfig &cfg) { layoutConfig = cfg; }
     void setTagTemplate (const TagTemplate &tpl) { tagTemplate = tpl; }
+    void setCompression (ZipCompression level) { compression = level; }
+
+    // Render windows in flight at once: 0 = one per core, 1 = serial on the calling thread (the reference
+    // the parallel output must match byte for byte - see benchmarks/DocxRenderBenchmark)
+    void setRenderThreads (int threads) { renderThreads = qMax (0, threads); }
 
     DocxLayoutConfig layout () const { return layoutConfig; }
 
     TagTemplate tagTpl () const { return tagTemplate; }
 
+    ZipCompression zipCompression () const { return compression; }
+
     bool generateWordDocument (const QList<PriceTag> &priceTags, const QString &outputPath);
+    bool generateWordDocument (const PriceTagTable &priceTags, const QString &outputPath);
+
+    // Streaming output for lists that do not fit in memory: tags are laid out as they arrive (each repeated
+    // by its quantity) and written through the compressor; only the current table row is kept.
+    bool beginStream (const QString &outputPath);
+    bool streamTag (const PriceTag &tag);
+    bool finishStream ();
+    void cancelStream (); // drops the partial output file
 
 
 private:
@@ -53,18 +76,21 @@ private:
 
     TagTemplate tagTemplate{};
 
+    ZipCompression compression = ZipCompression::Normal;
+
+    int renderThreads = 0;
+
     static inline int mmToTwips (double mm) { return static_cast<int> (mm * 1440.0 / 25.4 + 0.5); }
 
     static void computeGrid (const DocxLayoutConfig &cfg, int &nCols, int &nRows);
 
-    void writeContentTypes (QXlsx::ZipWriter &zip);
-    void writeRelsRoot (QXlsx::ZipWriter &zip);
-    void writeDocProps (QXlsx::ZipWriter &zip);
-    void writeStyles (QXlsx::ZipWriter &zip);
-    void writeSettings (QXlsx::ZipWriter &zip);
-    void writeDocumentXml (QXlsx::ZipWriter &zip, const QList<PriceTag> &expandedTags);
-
-    QString buildDocumentXml (const QList<PriceTag> &expandedTags);
+    void writeContentTypes (ZipStreamWriter &zip);
+    void writeRelsRoot (ZipStreamWriter &zip);
+    void writeDocProps (ZipStreamWriter &zip);
+    void writeStyles (ZipStreamWriter &zip);
+    void writeSettings (ZipStreamWriter &zip);
+    bool writeDocumentXml (ZipStreamWriter &zip, const ExpandedTagView &expandedTags);
+    void writePackageParts (ZipStreamWriter &zip);
 
 
 private:
@@ -89,15 +115,53 @@ private:
 
 
     // Helper methods for building document XML:
-    QString createDocumentHeader () const;
-    QString createOuterTableStructure (int tableWidth) const;
-    QString createOuterTableGrid (int columns, int tagWidth) const;
+    void createDocumentHeader (XmlByteBuilder &out) const;
+    void createOuterTableStructure (XmlByteBuilder &out, int tableWidth) const;
+    void createOuterTableGrid (XmlByteBuilder &out, int columns, int tagWidth) const;
 
-    QString addTableRows (const QList<PriceTag> &expandedTags, int columns, int tagWidth) const;
-    QString addSectionProperties (const DocumentDimensions &dims) const;
+    QByteArray createDocumentHead (const DocumentDimensions &dims) const; // up to the first table row
+    QByteArray createDocumentTail (const DocumentDimensions &dims) const;
+    QByteArray createPageSeparator (const DocumentDimensions &dims) const; // closes a page table, opens the next
+
+    // Rendered tag XML by content hash, kept for one render window; row is where the bytes came from
+    struct RenderedTag
+    {
+        int row = -1;
+        QByteArray xml;
+    };
+
+    using RenderedTagCache = QHash<quint64, RenderedTag>;
+
+    // Tags [begin, end) of the expanded list, columns per table row
+    void appendTableRows (QByteArray &out, const ExpandedTagView &expandedTags, qint64 begin, qint64 end, int columns,
+                          RenderedTagCache &cache) const;
+    void appendTableRow (QByteArray &out, const QVector<QByteArray> &cells, int columns) const;
+    QByteArray renderTag (const PriceTag &tag) const;
+    void addSectionProperties (XmlByteBuilder &out, const DocumentDimensions &dims) const;
 
 
     // Utilities:
     static QString xmlEscape (const QString &s);
-    static QString formatPrice (double price);
+
+
+    // Tag XML compiled for the current template and tag width (regular and discounted price row)
+    TagFragmentProgram regularTagProgram;
+    TagFragmentProgram discountedTagProgram;
+    QByteArray tagCellOpen;
+    QByteArray emptyCellContent;
+    int compiledTagWidth = 0;
+
+    void compileTagPrograms (int tagWidth);
+
+
+    // Streaming session state
+    ZipStreamWriter *stream = nullptr;
+    DocumentDimensions streamDims{};
+    QVector<QByteArray> streamRow; // rendered tags of the current table row
+    qint64 streamedTagCount = 0;
+    qint64 streamedRowCount = 0;
+    QByteArray streamPageSeparator; // empty unless tablePerPage
+    QString streamPath;
+
+    bool writeStreamRow ();
 };
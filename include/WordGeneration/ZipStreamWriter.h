@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+
+// Store writes entries uncompressed; Fast and Normal are zlib levels 1 and 6. Max is level 9 with entries cut into
+// 1 MB blocks deflated on several threads (each primed with the preceding 32 KB, pigz-style), so an entry is still
+// one deflate stream any unzip reads
+enum class ZipCompression
+{
+    Store,
+    Fast,
+    Normal,
+    Max
+};
+
+
+// Write-only ZIP package written straight to disk. Entries are compressed while they are written, so a part
+// of any size costs only the deflate window and one output chunk; sizes and CRC are patched into the local
+// header when the entry ends.
+class ZipStreamWriter
+{
+public:
+    explicit ZipStreamWriter (const QString &filePath, ZipCompression compression = ZipCompression::Normal);
+    ~ZipStreamWriter ();
+
+    bool isOpen () const { return file.isOpen (); }
+    bool hasError () const { return failed; }
+
+    // Whole entry at once - small parts
+    bool addFile (const QString &path, const QByteArray &data);
+
+    // Entry written in pieces; one entry can be open at a time
+    bool beginEntry (const QString &path);
+    bool writeEntryData (const char *data, qint64 size);
+    bool writeEntryData (const QByteArray &data) { return writeEntryData (data.constData (), data.size ()); }
+    bool endEntry ();
+
+    // Writes the central directory; false if anything failed along the way
+    bool close ();
+
+
+private:
+    struct Entry
+    {
+        QByteArray name;
+        quint16 method			  = 0;
+        quint32 crc				  = 0;
+        quint32 compressedSize	  = 0;
+        quint32 uncompressedSize  = 0;
+        quint32 localHeaderOffset = 0;
+    };
+
+
+    QFile file;
+    ZipCompression level;
+    QVector<Entry> entries;
+    bool entryOpen = false;
+    bool failed	   = false;
+
+    quint16 dosTime = 0;
+    quint16 dosDate = 0;
+
+    qint64 entryDataStart = 0;
+    qint64 entryRawSize	  = 0;
+    quint32 entryCrc	  = 0;
+
+    struct Deflater;
+    Deflater *deflater = nullptr;
+
+
+    bool writeRaw (const char *data, qint64 size);
+    bool deflateBlocks (bool finish); // Max: compresses the buffered whole blocks (all of them when finishing)
+    bool fail (const char *reason);
+
+    Q_DISABLE_COPY (ZipStreamWriter)
+};
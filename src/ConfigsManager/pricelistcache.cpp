@@ -0,0 +1,315 @@
+#include "pricelistcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QSaveFile>
+#include <QString>
+#include <QVector>
+
+#include "configmanager.h"
+#include "pricetag.h"
+
+
+namespace
+{
+    const quint32 cacheMagic		 = 0x50544d43; // "PTMC"
+    const quint32 cacheFormatVersion = 1;
+    const int stringFieldCount		 = 14;
+
+    QString cacheDirName () { return QStringLiteral ("ParsedCache"); }
+    QString cacheFileSuffix () { return QStringLiteral (".ptcache"); }
+
+
+    // Repeating values (supplier, brand, category...) are written once and referenced by index
+    class StringTableWriter
+    {
+    public:
+        quint32 indexOf (const QString &value)
+        {
+            const auto it = indices.constFind (value);
+            if (it != indices.constEnd ())
+                return it.value ();
+
+            const quint32 index = quint32 (strings.size ());
+
+            indices.insert (value, index);
+            strings.append (value);
+
+
+            return index;
+        }
+
+        const QVector<QString> &table () const { return strings; }
+
+
+    private:
+        QHash<QString, quint32> indices;
+        QVector<QString> strings;
+    };
+
+
+    QVector<quint32> tagStringIndices (const PriceTag &tag, StringTableWriter &table)
+    {
+        return {table.indexOf (tag.getName ()),
+                table.indexOf (tag.getDescription ()),
+                table.indexOf (tag.getSupplier ()),
+                table.indexOf (tag.getAddress ()),
+                table.indexOf (tag.getBrand ()),
+                table.indexOf (tag.getCategory ()),
+                table.indexOf (tag.getAdditionalData ()),
+                table.indexOf (tag.getGender ()),
+                table.indexOf (tag.getBrandCountry ()),
+                table.indexOf (tag.getManufacturingPlace ()),
+                table.indexOf (tag.getMaterial ()),
+                table.indexOf (tag.getSize ()),
+                table.indexOf (tag.getArticle ()),
+                table.indexOf (tag.getAdditionalData2 ())};
+    }
+
+    bool readTag (QDataStream &in, const QVector<QString> &table, PriceTag &tag)
+    {
+        quint32 idx[stringFieldCount];
+
+        for (quint32 &i : idx)
+        {
+            in >> i;
+
+            if (i >= quint32 (table.size ()))
+                return false;
+        }
+
+        double price  = 0.0;
+        double price2 = 0.0;
+        qint32 quantity = 0;
+
+        in >> price >> price2 >> quantity;
+
+        tag.setName (table.at (int (idx[0])));
+        tag.setDescription (table.at (int (idx[1])));
+        tag.setSupplier (table.at (int (idx[2])));
+        tag.setAddress (table.at (int (idx[3])));
+        tag.setBrand (table.at (int (idx[4])));
+        tag.setCategory (table.at (int (idx[5])));
+        tag.setAdditionalData (table.at (int (idx[6])));
+        tag.setGender (table.at (int (idx[7])));
+        tag.setBrandCountry (table.at (int (idx[8])));
+        tag.setManufacturingPlace (table.at (int (idx[9])));
+        tag.setMaterial (table.at (int (idx[10])));
+        tag.setSize (table.at (int (idx[11])));
+        tag.setArticle (table.at (int (idx[12])));
+        tag.setAdditionalData2 (table.at (int (idx[13])));
+
+        tag.setPrice (price);
+        tag.setPrice2 (price2);
+        tag.setQuantity (quantity);
+
+
+        return in.status () == QDataStream::Ok;
+    }
+
+
+    // Bytes store () writes: QDataStream puts a QString as a 32-bit length and UTF-16 data, a tag as its indices and numbers
+    qint64 entrySize (const QVector<QString> &table, int tagCount)
+    {
+        const qint64 tagSize = stringFieldCount * qint64 (sizeof (quint32)) + 2 * qint64 (sizeof (double)) + qint64 (sizeof (qint32));
+
+        qint64 size = 4 * qint64 (sizeof (quint32)); // magic, version, string count, tag count
+
+        for (const QString &value : table)
+            size += qint64 (sizeof (quint32)) + 2 * qint64 (value.size ());
+
+
+        return size + tagSize * tagCount;
+    }
+
+    // Marks the entry as recently used for eviction. Best effort: a read-only cache still loads.
+    void touchEntry (const QString &path)
+    {
+        QFile f (path);
+
+        if (f.open (QIODevice::Append))
+            f.setFileTime (QDateTime::currentDateTime (), QFileDevice::FileModificationTime);
+    }
+
+
+    QString cacheFilePath (const QString &key) { return QDir (PriceListCache::cacheDirPath ()).filePath (key + cacheFileSuffix ()); }
+} // namespace
+
+
+QString PriceListCache::cacheDirPath ()
+{
+    return QFileInfo (ConfigManager::templateConfigFilePath ()).dir ().filePath (cacheDirName ());
+}
+
+
+QString PriceListCache::cacheKey (const QByteArray &fileContent, int parserVersion, const QString &sheetScope)
+{
+    if (fileContent.isEmpty ())
+        return QString ();
+
+    QCryptographicHash hash (QCryptographicHash::Sha1);
+
+    hash.addData (fileContent);
+    hash.addData (QByteArray::number (parserVersion));
+    hash.addData (sheetScope.toUtf8 ());
+
+
+    return QString::fromLatin1 (hash.result ().toHex ());
+}
+
+
+bool PriceListCache::load (const QString &key, QList<PriceTag> &outTags)
+{
+    if (key.isEmpty ())
+        return false;
+
+    QFile f (cacheFilePath (key));
+    if (! f.open (QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in (&f);
+    in.setVersion (QDataStream::Qt_5_9);
+
+    quint32 magic	= 0;
+    quint32 version = 0;
+    in >> magic >> version;
+
+    if (magic != cacheMagic || version != cacheFormatVersion)
+        return false;
+
+
+    quint32 stringCount = 0;
+    in >> stringCount;
+
+    QVector<QString> table;
+    table.reserve (int (qMin<quint32> (stringCount, 1u << 20)));
+
+    for (quint32 i = 0; i < stringCount && in.status () == QDataStream::Ok; ++i)
+    {
+        QString value;
+        in >> value;
+        table.append (value);
+    }
+
+    quint32 tagCount = 0;
+    in >> tagCount;
+
+    QList<PriceTag> tags;
+    tags.reserve (int (qMin<quint32> (tagCount, 1u << 20)));
+
+    for (quint32 i = 0; i < tagCount; ++i)
+    {
+        PriceTag tag;
+
+        if (! readTag (in, table, tag))
+        {
+            qDebug () << "Corrupted price list cache entry, ignoring:" << f.fileName ();
+
+            return false;
+        }
+
+        tags.append (tag);
+    }
+
+    f.close ();
+    touchEntry (f.fileName ());
+
+    outTags.append (tags);
+
+    qDebug () << "Loaded" << tags.size () << "price tags from cache";
+
+
+    return true;
+}
+
+
+bool PriceListCache::store (const QString &key, const QList<PriceTag> &tags)
+{
+    if (key.isEmpty ())
+        return false;
+
+    QDir dir (cacheDirPath ());
+    if (! dir.exists () && ! dir.mkpath ("."))
+        return false;
+
+
+    StringTableWriter table;
+    QVector<QVector<quint32>> tagIndices;
+    tagIndices.reserve (tags.size ());
+
+    for (const PriceTag &tag : tags)
+        tagIndices.append (tagStringIndices (tag, table));
+
+    // evict () would delete an entry over the budget right after writing it
+    if (entrySize (table.table (), tags.size ()) > defaultMaxBytes)
+    {
+        qDebug () << "Price list too large for the cache, not stored:" << tags.size () << "price tags";
+
+        return false;
+    }
+
+
+    QSaveFile f (cacheFilePath (key));
+    if (! f.open (QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out (&f);
+    out.setVersion (QDataStream::Qt_5_9);
+
+    out << cacheMagic << cacheFormatVersion;
+
+    out << quint32 (table.table ().size ());
+    for (const QString &value : table.table ())
+        out << value;
+
+    out << quint32 (tags.size ());
+
+    for (int i = 0; i < tags.size (); ++i)
+    {
+        for (quint32 index : tagIndices.at (i))
+            out << index;
+
+        out << tags.at (i).getPrice () << tags.at (i).getPrice2 () << qint32 (tags.at (i).getQuantity ());
+    }
+
+    if (out.status () != QDataStream::Ok || ! f.commit ())
+        return false;
+
+    evict (defaultMaxBytes);
+
+
+    return true;
+}
+
+
+void PriceListCache::evict (qint64 maxBytes)
+{
+    QDir dir (cacheDirPath ());
+    if (! dir.exists ())
+        return;
+
+    // Newest first: everything past the budget is the least recently used
+    const QFileInfoList entries = dir.entryInfoList ({QStringLiteral ("*") + cacheFileSuffix ()}, QDir::Files, QDir::Time);
+
+    qint64 total = 0;
+
+
+    for (const QFileInfo &entry : entries)
+    {
+        total += entry.size ();
+
+        if (total > maxBytes)
+        {
+            qDebug () << "Evicting cached price list:" << entry.fileName ();
+
+            QFile::remove (entry.absoluteFilePath ());
+        }
+    }
+}
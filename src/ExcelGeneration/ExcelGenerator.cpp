@@ -9,7 +9,9 @@
 #include <xlsxworksheet.h>
 
 #include "Constants.h"
+#include "expandedtagview.h"
 #include "pricetag.h"
+#include "pricetagtable.h"
 
 #include "ExcelFormats.h"
 #include "ExcelLayout.h"
@@ -22,6 +24,11 @@ ExcelGenerator::~ExcelGenerator () {}
 
 
 bool ExcelGenerator::generateExcelDocument (const QList<PriceTag> &priceTags, const QString &outputPath)
+{
+    return generateExcelDocument (PriceTagTable::fromList (priceTags), outputPath);
+}
+
+bool ExcelGenerator::generateExcelDocument (const PriceTagTable &priceTags, const QString &outputPath)
 {
     qDebug () << "Generating Excel document with" << priceTags.size () << "price tags";
 
@@ -43,51 +50,57 @@ bool ExcelGenerator::generateExcelDocument (const QList<PriceTag> &priceTags, co
         xlsx.setRowHeight (i, mmToRowHeightPt (4.0));
 
 
-    int tagIndex		  = 0;
+    const ExpandedTagView expanded (priceTags);
     const int rowsPerPage = std::max (1, grid.nRows);
+    const int perPage	  = grid.nCols * rowsPerPage;
 
+    qDebug () << "perPage: " << perPage;
+
+    // Copies of one table row share a single materialized PriceTag
+    PriceTag tag;
+    int currentRow = -1;
 
-    for (const PriceTag &tag : priceTags)
-    {
-        const int perPage = grid.nCols * rowsPerPage;
-        qDebug () << "perPage: " << perPage;
 
+    for (qint64 tagIndex = 0; tagIndex < expanded.size (); ++tagIndex)
+    {
+        const int sourceRow = expanded.slot (tagIndex).row;
 
-        for (int q = 0; q < tag.getQuantity (); ++q)
+        if (sourceRow != currentRow)
         {
-            const int pageIdx	= tagIndex / perPage;
-            const int idxInPage = tagIndex % perPage;
-            const int gridRow	= idxInPage / grid.nCols;
-            const int gridCol	= idxInPage % grid.nCols;
+            tag		   = priceTags.at (sourceRow);
+            currentRow = sourceRow;
+        }
 
+        const int pageIdx	= int (tagIndex / perPage);
+        const int idxInPage = int (tagIndex % perPage);
+        const int gridRow	= idxInPage / grid.nCols;
+        const int gridCol	= idxInPage % grid.nCols;
 
-            int col = 0, row = 0, tagCols = 0, tagRows = 0;
-            ExcelGen::placeTagCellRange (layoutConfig, gridCol, gridRow, originCol, originRow, col, row, tagCols, tagRows);
-            const int pageGapRows = 1;
 
-            row += pageIdx * (rowsPerPage * tagRows + pageGapRows);
-            qDebug () << "idxInPage: " << idxInPage;
+        int col = 0, row = 0, tagCols = 0, tagRows = 0;
+        ExcelGen::placeTagCellRange (layoutConfig, gridCol, gridRow, originCol, originRow, col, row, tagCols, tagRows);
+        const int pageGapRows = 1;
 
+        row += pageIdx * (rowsPerPage * tagRows + pageGapRows);
+        qDebug () << "idxInPage: " << idxInPage;
 
-            if (idxInPage == perPage - 1)
-            {
-                const double pageH		 = ExcelGen::printableHeightMm (layoutConfig);
-                const double safetyPadMm = 6.5;
-                double gapMm			 = pageH - grid.pageUsedMm + safetyPadMm;
 
-                if (gapMm < 2.)
-                    gapMm = 6.5;
+        if (idxInPage == perPage - 1)
+        {
+            const double pageH		 = ExcelGen::printableHeightMm (layoutConfig);
+            const double safetyPadMm = 6.5;
+            double gapMm			 = pageH - grid.pageUsedMm + safetyPadMm;
 
-                xlsx.setRowHeight (row + tagRows, mmToRowHeightPt (gapMm));
-            }
+            if (gapMm < 2.)
+                gapMm = 6.5;
 
-            qDebug () << "Creating price tag" << tagIndex << "at position (" << row << "," << col << ")";
+            xlsx.setRowHeight (row + tagRows, mmToRowHeightPt (gapMm));
+        }
 
+        qDebug () << "Creating price tag" << tagIndex << "at position (" << row << "," << col << ")";
 
-            ExcelGen::renderTag (xlsx, row, col, tagCols, tagRows, tag, tagTemplate, layoutConfig, tf);
 
-            tagIndex++;
-        }
+        ExcelGen::renderTag (xlsx, row, col, tagCols, tagRows, tag, tagTemplate, layoutConfig, tf);
     }
 
 
@@ -1,5 +1,7 @@
 #include "ExcelUtils.h"
 
+#include "XmlEscape.h"
+
 
 namespace ExcelGen
 {
@@ -55,9 +57,11 @@ namespace ExcelGen
         return n;
     }
 
-    void writeWithInvisiblePad (QXlsx::Document &xlsx, int row, int col, const QXlsx::Format &cellFmt, const QString &text)
+    void writeWithInvisiblePad (QXlsx::Document &xlsx, int row, int col, const QXlsx::Format &cellFmt, const QString &rawText)
     {
-        const int lead = countLeadingSpacesGeneric (text);
+        // QXlsx escapes markup itself but passes control characters through, which breaks the sheet XML
+        const QString text = XmlEscape::sanitized (rawText);
+        const int lead	   = countLeadingSpacesGeneric (text);
 
         if (lead <= 0)
         {
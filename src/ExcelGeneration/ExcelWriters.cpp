@@ -21,8 +21,8 @@ namespace ExcelGen
 
         xlsx.mergeCells (QXlsx::CellRange (row + 1, col, row + 1, col + tagCols - 1), fmt);
 
-        const QString txt = tag.getBrand ();
-        const int lead	  = countLeadingSpacesGeneric (txt);
+        const QString &txt = tag.getBrand ();
+        const int lead	   = countLeadingSpacesGeneric (txt);
 
         if (lead > 0)
             fmt.setIndent (qMin (15, lead));
@@ -122,12 +122,12 @@ namespace ExcelGen
     void writePriceRow (QXlsx::Document &xlsx, int row, int col, int tagCols, const PriceTag &tag, const TagTemplate &tagTemplate,
                         const TagFormats &tf)
     {
-        Q_UNUSED (tagTemplate);
+        const bool grouping = tagTemplate.priceThousandsGrouping;
 
 
-        if (tag.getPrice2 () > 0)
+        if (tag.getPrice2Money ().isPositive ())
         {
-            QString priceText			 = QString::number (tag.getPrice ());
+            QString priceText			 = tag.getPriceMoney ().toString (grouping);
             QXlsx::Format fmtLeft		 = withOuterEdges (tf.strikePriceFormat, true, false, false, false);
             const QXlsx::Format fmtRight = withOuterEdges (tf.priceFormatCell2, false, true, false, false);
             const int lead				 = countLeadingSpacesGeneric (priceText);
@@ -137,7 +137,7 @@ namespace ExcelGen
 
             xlsx.write (row + 7, col, priceText.mid (lead), fmtLeft);
             xlsx.mergeCells (QXlsx::CellRange (row + 7, col + 1, row + 7, col + tagCols - 1), fmtRight);
-            xlsx.write (row + 7, col + 1, QString::number (tag.getPrice2 ()) + " =", fmtRight);
+            xlsx.write (row + 7, col + 1, tag.getPrice2Money ().toString (grouping) + " =", fmtRight);
         }
         else
         {
@@ -150,7 +150,7 @@ namespace ExcelGen
             writeWithInvisiblePad (xlsx, row + 7, col, fmtLeft, QString::fromUtf8 ("Цена: "));
 
             xlsx.mergeCells (QXlsx::CellRange (row + 7, col + 1, row + 7, col + tagCols - 1), fmtRight);
-            xlsx.write (row + 7, col + 1, QString::number (tag.getPrice ()) + " =", fmtRight);
+            xlsx.write (row + 7, col + 1, tag.getPriceMoney ().toString (grouping) + " =", fmtRight);
         }
     }
 
@@ -0,0 +1,394 @@
+#include "CsvRowSource.h"
+
+#include <QDebug>
+#include <QtAlgorithms>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSV_SCAN_SSE2
+#endif
+
+
+namespace
+{
+    const int formatSampleSize = 64 * 1024;
+
+    // CP1251 0x80..0xBF; 0xC0..0xFF map linearly onto U+0410..U+044F
+    const ushort cp1251Upper[64] = {
+            0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021, 0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,
+            0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0xFFFD, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,
+            0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7, 0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,
+            0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7, 0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457};
+
+
+    // First position in [p, end) holding the delimiter, a quote, CR or LF; end when there is none
+    const char *findSpecial (const char *p, const char *end, char delimiter)
+    {
+#ifdef CSV_SCAN_SSE2
+        const __m128i delim = _mm_set1_epi8 (delimiter);
+        const __m128i quote = _mm_set1_epi8 ('"');
+        const __m128i lf	= _mm_set1_epi8 ('\n');
+        const __m128i cr	= _mm_set1_epi8 ('\r');
+
+        while (end - p >= 16)
+        {
+            const __m128i chunk = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (p));
+            const __m128i hits	= _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (chunk, delim), _mm_cmpeq_epi8 (chunk, quote)),
+                                                _mm_or_si128 (_mm_cmpeq_epi8 (chunk, lf), _mm_cmpeq_epi8 (chunk, cr)));
+            const int mask		= _mm_movemask_epi8 (hits);
+
+            if (mask != 0)
+                return p + qCountTrailingZeroBits (quint32 (mask));
+
+            p += 16;
+        }
+#endif
+
+        while (p < end && *p != delimiter && *p != '"' && *p != '\n' && *p != '\r')
+            ++p;
+
+
+        return p;
+    }
+
+    // Strict UTF-8 check (no overlongs, surrogates or code points past U+10FFFF); ASCII runs are skipped 16 bytes at a time
+    bool isValidUtf8 (const char *data, const char *end)
+    {
+        const unsigned char *p	 = reinterpret_cast<const unsigned char *> (data);
+        const unsigned char *e	 = reinterpret_cast<const unsigned char *> (end);
+
+
+        while (p < e)
+        {
+#ifdef CSV_SCAN_SSE2
+            if (e - p >= 16 && _mm_movemask_epi8 (_mm_loadu_si128 (reinterpret_cast<const __m128i *> (p))) == 0)
+            {
+                p += 16;
+
+                continue;
+            }
+#endif
+
+            const unsigned char c = *p;
+
+            if (c < 0x80)
+            {
+                ++p;
+
+                continue;
+            }
+
+            int length		= 0;
+            quint32 minimum = 0;
+            quint32 cp		= 0;
+
+            if ((c & 0xE0) == 0xC0)
+            {
+                length	= 2;
+                minimum = 0x80;
+                cp		= c & 0x1F;
+            }
+            else if ((c & 0xF0) == 0xE0)
+            {
+                length	= 3;
+                minimum = 0x800;
+                cp		= c & 0x0F;
+            }
+            else if ((c & 0xF8) == 0xF0)
+            {
+                length	= 4;
+                minimum = 0x10000;
+                cp		= c & 0x07;
+            }
+            else
+                return false;
+
+            if (e - p < length)
+                return false;
+
+            for (int i = 1; i < length; ++i)
+            {
+                if ((p[i] & 0xC0) != 0x80)
+                    return false;
+
+                cp = (cp << 6) | (p[i] & 0x3F);
+            }
+
+            if (cp < minimum || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+                return false;
+
+            p += length;
+        }
+
+
+        return true;
+    }
+
+    QString decodeCp1251 (const char *begin, const char *end)
+    {
+        QString text (int (end - begin), Qt::Uninitialized);
+        QChar *out = text.data ();
+
+        for (const char *p = begin; p < end; ++p, ++out)
+        {
+            const uchar b = uchar (*p);
+
+            if (b < 0x80)
+                *out = QChar (b);
+            else if (b < 0xC0)
+                *out = QChar (cp1251Upper[b - 0x80]);
+            else
+                *out = QChar (ushort (0x0410 + (b - 0xC0)));
+        }
+
+
+        return text;
+    }
+} // namespace
+
+
+CsvRowSource::CsvRowSource (const QString &filePath, char delimiter) : file (filePath), separator (delimiter) {}
+
+CsvRowSource::~CsvRowSource ()
+{
+    if (bytes && loadedData.isEmpty ())
+        file.unmap (reinterpret_cast<uchar *> (const_cast<char *> (bytes)));
+}
+
+
+bool CsvRowSource::mapFile ()
+{
+    if (! file.open (QIODevice::ReadOnly))
+    {
+        qDebug () << "Cannot open file for read:" << file.fileName ();
+
+        return false;
+    }
+
+    size = file.size ();
+    if (size <= 0)
+        return false;
+
+    if (uchar *mapped = file.map (0, size))
+    {
+        bytes = reinterpret_cast<const char *> (mapped);
+
+        return true;
+    }
+
+    loadedData = file.readAll ();
+
+    if (loadedData.size () != size)
+        return false;
+
+    bytes = loadedData.constData ();
+
+
+    return true;
+}
+
+void CsvRowSource::detectFormat ()
+{
+    dataStart = (size >= 3 && std::memcmp (bytes, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+    utf8	  = dataStart == 3 || isValidUtf8 (bytes, bytes + size);
+
+    const char *const sampleEnd = bytes + qMin<qint64> (size, dataStart + formatSampleSize);
+
+
+    // Delimiter: the most frequent of ';', ',' and tab on the first line, quotes respected
+    if (separator == 0)
+    {
+        int semicolons = 0;
+        int commas	   = 0;
+        int tabs	   = 0;
+        bool quoted	   = false;
+
+        for (const char *p = bytes + dataStart; p < sampleEnd; ++p)
+        {
+            if (*p == '"')
+                quoted = ! quoted;
+            else if (! quoted && (*p == '\n' || *p == '\r'))
+                break;
+            else if (! quoted && *p == ';')
+                ++semicolons;
+            else if (! quoted && *p == ',')
+                ++commas;
+            else if (! quoted && *p == '\t')
+                ++tabs;
+        }
+
+        separator = ';';
+
+        if (commas > semicolons && commas >= tabs)
+            separator = ',';
+        else if (tabs > semicolons && tabs > commas)
+            separator = '\t';
+    }
+
+
+    // Row estimate for progress: line count of the sample scaled to the file size
+    qint64 sampleLines = 0;
+
+    for (const char *p = bytes + dataStart; p < sampleEnd; ++p)
+    {
+        if (*p == '\n')
+            ++sampleLines;
+    }
+
+    const qint64 sampleSize = sampleEnd - (bytes + dataStart);
+
+    rowEstimate = sampleLines > 0 ? int (qMin<qint64> (size * sampleLines / sampleSize, std::numeric_limits<int>::max ())) : 1;
+
+    qDebug () << "CSV format:" << (utf8 ? "UTF-8" : "CP1251") << "delimiter" << QString (QLatin1Char (separator));
+}
+
+
+bool CsvRowSource::open ()
+{
+    if (! bytes)
+    {
+        if (! mapFile ())
+            return false;
+
+        detectFormat ();
+    }
+
+    pos		 = dataStart;
+    rowIndex = 0;
+    wanted.clear ();
+
+
+    return true;
+}
+
+void CsvRowSource::setWantedColumns (const QVector<int> &columns)
+{
+    wanted.clear ();
+
+    for (int col : columns)
+    {
+        if (col <= 0)
+            continue;
+
+        if (wanted.size () <= col)
+            wanted.resize (col + 1);
+
+        wanted[col] = true;
+    }
+}
+
+
+bool CsvRowSource::nextRow (SheetRow &row)
+{
+    if (! bytes)
+        return false;
+
+    const char *const end = bytes + size;
+
+
+    while (pos < size)
+    {
+        const char *p = bytes + pos;
+
+        row.rowIndex = ++rowIndex;
+        row.cells.resize (1);
+
+        bool anyValue = false;
+        bool rowEnded = false;
+
+        for (int col = 1; ! rowEnded; ++col)
+        {
+            const char *fieldBegin	= p;
+            const char *fieldEnd	= p;
+            const bool quotedField	= (p < end && *p == '"');
+            bool escapedQuotes		= false;
+
+            if (quotedField)
+            {
+                // Quoted field: may hold delimiters, line breaks and "" for a literal quote; unterminated runs to the end
+                fieldBegin = ++p;
+                fieldEnd   = end;
+
+                while (const char *q = static_cast<const char *> (std::memchr (p, '"', size_t (end - p))))
+                {
+                    if (q + 1 < end && q[1] == '"')
+                    {
+                        escapedQuotes = true;
+                        p			  = q + 2;
+
+                        continue;
+                    }
+
+                    fieldEnd = q;
+                    p		 = q + 1;
+
+                    break;
+                }
+
+                if (fieldEnd == end)
+                    p = end;
+            }
+
+            // Up to the delimiter or line end; quotes inside an unquoted field (or after a closing quote) are literal
+            for (;;)
+            {
+                p = findSpecial (p, end, separator);
+
+                if (p < end && *p == '"')
+                {
+                    ++p;
+
+                    continue;
+                }
+
+                break;
+            }
+
+            if (! quotedField)
+                fieldEnd = p;
+
+            const bool isWanted = wanted.isEmpty () || (col < wanted.size () && wanted.at (col));
+
+            if (fieldEnd > fieldBegin && isWanted)
+            {
+                if (row.cells.size () <= col)
+                    row.cells.resize (col + 1);
+
+                row.cells[col] = decodeField (fieldBegin, fieldEnd, escapedQuotes);
+                anyValue	   = true;
+            }
+
+            if (p >= end)
+                rowEnded = true;
+            else if (*p == separator)
+                ++p;
+            else
+            {
+                p += (*p == '\r' && p + 1 < end && p[1] == '\n') ? 2 : 1;
+                rowEnded = true;
+            }
+        }
+
+        pos = p - bytes;
+
+        if (anyValue)
+            return true;
+    }
+
+
+    return false;
+}
+
+
+QString CsvRowSource::decodeField (const char *begin, const char *end, bool hasEscapedQuotes) const
+{
+    QString text = utf8 ? QString::fromUtf8 (begin, int (end - begin)) : decodeCp1251 (begin, end);
+
+    if (hasEscapedQuotes)
+        text.replace (QLatin1String ("\"\""), QLatin1String ("\""));
+
+
+    return text;
+}
@@ -1,23 +1,239 @@
 #include "ExcelParser.h"
 
+#include <QBuffer>
 #include <QDebug>
-#include <QFile>
 #include <QFileInfo>
 #include <QList>
-#include <QMap>
-#include <QRegularExpression>
 #include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <xlsxzipreader_p.h>
 #include "xlsxabstractsheet.h"
 #include "xlsxcell.h"
 
+#include "CsvRowSource.h"
+#include "HeaderDictionary.h"
+#include "NumericScanner.h"
+#include "XlsxStreamReader.h"
+#include "XlsxZipArchive.h"
+#include "pricelistcache.h"
 #include "pricetag.h"
+#include "stringpool.h"
 
 
-ExcelParser::ExcelParser (QObject *parent) : QObject (parent) {}
+namespace
+{
+    const qint64 progressRowStep = 1024;
+
+
+    bool isDelimitedTextFile (const QString &filePath)
+    {
+        const QString suffix = QFileInfo (filePath).suffix ();
+
+
+        return suffix.compare (QLatin1String ("csv"), Qt::CaseInsensitive) == 0 ||
+               suffix.compare (QLatin1String ("tsv"), Qt::CaseInsensitive) == 0;
+    }
+
+    QStringList listArchiveEntries (const XlsxZipArchive &archive)
+    {
+        if (archive.isValid ())
+            return archive.filePaths ();
+
+        // Central directory our reader does not handle (e.g. ZIP64) - let QXlsx list the entries
+        QBuffer buffer;
+        buffer.setData (archive.rawData ());
+        buffer.open (QIODevice::ReadOnly);
+
+
+        return QXlsx::ZipReader (&buffer).filePaths ();
+    }
+
+    bool hasLatin1RangeChars (const QString &text)
+    {
+        for (const QChar ch : text)
+        {
+            if (ch.unicode () >= 0x80 && ch.unicode () <= 0xFF)
+                return true;
+        }
+
+
+        return false;
+    }
+
+
+    // Adapts an already loaded QXlsx document to the row source interface (fallback path)
+    class DocumentRowSource: public SheetRowSource
+    {
+    public:
+        DocumentRowSource (QXlsx::Document &xlsx, const QXlsx::CellRange &range) : xlsx (xlsx), range (range) {}
+
+        bool open () override
+        {
+            currentRow = range.firstRow ();
+
+            return true;
+        }
+
+        bool nextRow (SheetRow &row) override
+        {
+            if (currentRow > range.lastRow ())
+                return false;
+
+            row.rowIndex = currentRow;
+            row.cells.resize (range.lastColumn () + 1);
+
+            for (int col = 0; col < row.cells.size (); ++col)
+                row.cells[col] = (col >= range.firstColumn ()) ? xlsx.read (currentRow, col) : QVariant ();
+
+            ++currentRow;
+
+
+            return true;
+        }
+
+        int estimatedRows () const override { return range.lastRow (); }
+
+
+    private:
+        QXlsx::Document &xlsx;
+        QXlsx::CellRange range;
+        int currentRow = 1;
+    };
+} // namespace
+
+
+ExcelParser::ExcelParser (QObject *parent) : QObject (parent)
+{
+    asyncWatcher = new QFutureWatcher<AsyncResult> (this);
+
+    connect (asyncWatcher, &QFutureWatcherBase::finished, this,
+             [this] ()
+             {
+                 const AsyncResult result = asyncWatcher->result ();
+
+                 emit parsingFinished (result.filePath, result.success, result.priceTags);
+             });
+}
+
+ExcelParser::~ExcelParser ()
+{
+    // The worker uses this object, so it has to be gone before the members are
+    cancel ();
+    asyncWatcher->waitForFinished ();
+}
+
+
+bool ExcelParser::parseAsync (const QString &filePath)
+{
+    if (isParsing ())
+        return false;
+
+    cancelRequested = false;
+
+    asyncWatcher->setFuture (QtConcurrent::run (
+            [this, filePath] ()
+            {
+                AsyncResult result;
+
+                result.filePath = filePath;
+                result.success	= parseFile (filePath, result.priceTags);
+
+
+                return result;
+            }));
+
+
+    return true;
+}
+
+void ExcelParser::cancel ()
+{
+    if (isParsing ())
+        cancelRequested = true;
+}
+
+bool ExcelParser::isParsing () const { return asyncWatcher->isRunning (); }
+
 
-ExcelParser::~ExcelParser () {}
+void ExcelParser::setParseAllSheets (bool enabled) { parseAllSheets = enabled; }
+
+void ExcelParser::setSelectedSheets (const QStringList &sheetNames) { selectedSheets = sheetNames; }
+
+QString ExcelParser::sheetScopeKey () const
+{
+    if (! selectedSheets.isEmpty ())
+        return QStringLiteral ("sheets:") + selectedSheets.join (QLatin1Char ('\n'));
+
+
+    return parseAllSheets ? QStringLiteral ("all") : QStringLiteral ("active");
+}
+
+
+bool ExcelParser::isSupportedFile (const QString &filePath)
+{
+    return isDelimitedTextFile (filePath) || QFileInfo (filePath).suffix ().compare (QLatin1String ("xlsx"), Qt::CaseInsensitive) == 0;
+}
+
+bool ExcelParser::parseFile (const QString &filePath, QList<PriceTag> &priceTags)
+{
+    if (isDelimitedTextFile (filePath))
+        return parseDelimitedTextFile (filePath, priceTags);
+
+
+    return parseExcelFile (filePath, priceTags);
+}
+
+bool ExcelParser::parseFileStreaming (const QString &filePath, const TagSink &sink)
+{
+    tagSink		 = sink;
+    streamedTags = 0;
+
+    QList<PriceTag> unused;
+    const bool parsed = parseFile (filePath, unused);
+
+    tagSink = nullptr;
+
+
+    return parsed;
+}
+
+bool ExcelParser::parseDelimitedTextFile (const QString &filePath, QList<PriceTag> &priceTags)
+{
+    qDebug () << "Starting to parse delimited text file:" << filePath;
+
+    rowsProcessed = 0;
+    rowsEstimated = 0;
+
+    // TSV is always tab separated; CSV from Excel uses ';' or ',' depending on locale, so that one is sniffed
+    const bool isTsv = QFileInfo (filePath).suffix ().compare (QLatin1String ("tsv"), Qt::CaseInsensitive) == 0;
+    CsvRowSource source (filePath, isTsv ? '\t' : 0);
+
+    if (! source.open ())
+        return false;
+
+    const bool parsed = parseRowSource (source, priceTags);
+
+    if (cancelRequested)
+    {
+        qDebug () << "Parsing cancelled:" << filePath;
+
+        return false;
+    }
+
+    if (! parsed)
+        return false;
+
+    emit progressChanged (rowsProcessed, rowsEstimated);
+
+    qDebug () << "Parsed" << priceTags.size () << "price tags";
+
+
+    return ! priceTags.isEmpty () || streamedTags > 0;
+}
 
 
 bool ExcelParser::parseExcelFile (const QString &filePath, QList<PriceTag> &priceTags)
@@ -32,47 +248,222 @@ bool ExcelParser::parseExcelFile (const QString &filePath, QList<PriceTag> &pric
         return false;
     }
 
-    if (! quickZipSignatureCheck (filePath))
-        return false;
+    rowsProcessed = 0;
+    rowsEstimated = 0;
 
-    if (! preScanZipForWorkbookAndSheets (filePath))
+    // One handle for the whole parse: the file is mapped once and shared by hashing, validation and all readers
+    const XlsxZipArchive archive (filePath);
+
+    if (! archive.isOpen ())
         return false;
 
-    QXlsx::Document xlsx (filePath);
+    // A hit skips the ZIP checks and the whole parse; the key changes with file content, parser version and sheet scope
+    const QString cacheKey = PriceListCache::cacheKey (archive.rawData (), parserVersion, sheetScopeKey ());
+
+    if (! tagSink && PriceListCache::load (cacheKey, priceTags))
+        return ! priceTags.isEmpty ();
 
-    QXlsx::CellRange range;
-    if (! readAndValidateDimension (xlsx, range))
+    if (! quickZipSignatureCheck (archive))
         return false;
 
-    ColumnMapping columnMapping;
-    if (! findHeaders (&xlsx, range, columnMapping))
+    if (! preScanZipForWorkbookAndSheets (archive))
+        return false;
+
+    bool handled = false;
+    bool parsed	 = parseWithStreamingReader (archive, priceTags, handled);
+
+    if (! handled)
     {
-        qDebug () << "Failed to find required headers";
+        qDebug () << "Streaming reader could not open the workbook, falling back to QXlsx::Document";
+
+        parsed = parseWithDocument (archive, priceTags);
+    }
+
+    if (cancelRequested)
+    {
+        qDebug () << "Parsing cancelled:" << filePath;
 
         return false;
     }
 
-    parseAllRows (xlsx, range, columnMapping, priceTags);
+    if (! parsed)
+        return false;
+
+    emit progressChanged (rowsProcessed, rowsEstimated);
 
     qDebug () << "Parsed" << priceTags.size () << "price tags";
 
+    if (! tagSink && ! priceTags.isEmpty ())
+        PriceListCache::store (cacheKey, priceTags);
+
 
-    return ! priceTags.isEmpty ();
+    return ! priceTags.isEmpty () || streamedTags > 0;
 }
 
-bool ExcelParser::quickZipSignatureCheck (const QString &filePath) const
+bool ExcelParser::parseWithStreamingReader (const XlsxZipArchive &archive, QList<PriceTag> &priceTags, bool &handled)
 {
-    QFile f (filePath);
-    if (! f.open (QIODevice::ReadOnly))
+    handled = false;
+
+    if (! archive.isValid ())
+        return false;
+
+    XlsxStreamWorkbook workbook (archive);
+    if (! workbook.load ())
+        return false;
+
+    QStringList names;
+    for (int i = 0; i < workbook.sheetCount (); ++i)
+        names.append (workbook.sheetName (i));
+
+
+    // Every sheet gets its own reader, header detection and forward-fill state; the workbook is only read
+    struct SheetJob
+    {
+        int sheetIndex = 0;
+        bool opened	   = false;
+        bool parsed	   = false;
+        QList<PriceTag> tags;
+    };
+
+    QVector<SheetJob> jobs;
+
+    for (int index : resolveSheetIndices (names, workbook.activeSheetIndex ()))
     {
-        qDebug () << "Cannot open file for read:" << filePath;
+        if (workbook.sheetPath (index).isEmpty ())
+            continue;
 
+        SheetJob job;
+        job.sheetIndex = index;
+        jobs.append (job);
+    }
+
+    auto parseSheet = [this, &workbook] (SheetJob &job)
+    {
+        XlsxSheetReader reader (workbook, job.sheetIndex);
+
+        job.opened = reader.open ();
+        if (! job.opened)
+            return;
+
+        qDebug () << "Streaming sheet:" << workbook.sheetName (job.sheetIndex);
+
+        job.parsed = parseRowSource (reader, job.tags);
+    };
+
+    if (jobs.size () > 1 && ! tagSink)
+        QtConcurrent::blockingMap (jobs, parseSheet);
+    else
+    {
+        // A sink has to see the tags in workbook order
+        for (SheetJob &job : jobs)
+            parseSheet (job);
+    }
+
+
+    // Merge in workbook order so the result does not depend on which sheet finished first
+    bool parsed = false;
+
+    for (const SheetJob &job : jobs)
+    {
+        handled = handled || job.opened;
+        parsed	= parsed || job.parsed;
+
+        priceTags.append (job.tags);
+    }
+
+
+    return parsed;
+}
+
+bool ExcelParser::parseWithDocument (const XlsxZipArchive &archive, QList<PriceTag> &priceTags)
+{
+    // QXlsx reads from the already mapped bytes instead of opening the file again
+    QBuffer buffer;
+    buffer.setData (archive.rawData ());
+
+    if (! buffer.open (QIODevice::ReadOnly))
         return false;
+
+    QXlsx::Document xlsx (&buffer);
+
+    const QStringList names = xlsx.sheetNames ();
+    const int activeIndex	= names.indexOf (xlsx.currentSheet () ? xlsx.currentSheet ()->sheetName () : QString ());
+
+    bool parsed = false;
+
+
+    // QXlsx::Document is not thread-safe, so the fallback walks the sheets one after another
+    for (int index : resolveSheetIndices (names, qMax (activeIndex, 0)))
+    {
+        if (! names.isEmpty () && ! xlsx.selectSheet (names.at (index)))
+            continue;
+
+        QXlsx::CellRange range;
+        if (! readAndValidateDimension (xlsx, range))
+            continue;
+
+        DocumentRowSource source (xlsx, range);
+
+        if (source.open () && parseRowSource (source, priceTags))
+            parsed = true;
     }
 
-    QByteArray sig = f.read (4);
-    f.close ();
-    if (sig.size () != 4 || ! (sig[0] == 'P' && sig[1] == 'K'))
+
+    return parsed;
+}
+
+QVector<int> ExcelParser::resolveSheetIndices (const QStringList &sheetNames, int activeIndex) const
+{
+    QVector<int> indices;
+
+    if (! selectedSheets.isEmpty ())
+    {
+        for (int i = 0; i < sheetNames.size (); ++i)
+        {
+            if (selectedSheets.contains (sheetNames.at (i)))
+                indices.append (i);
+        }
+
+        if (indices.isEmpty ())
+            qDebug () << "None of the selected sheets found:" << selectedSheets;
+    }
+    else if (parseAllSheets)
+    {
+        for (int i = 0; i < sheetNames.size (); ++i)
+            indices.append (i);
+    }
+    else
+        indices.append (activeIndex);
+
+
+    return indices;
+}
+
+bool ExcelParser::parseRowSource (SheetRowSource &source, QList<PriceTag> &priceTags)
+{
+    rowsEstimated += source.estimatedRows ();
+
+    // Single pass over an opened source: findHeaders consumes rows up to the header row, parseAllRows streams the rest
+    ColumnMapping columnMapping;
+    if (! findHeaders (source, columnMapping))
+    {
+        qDebug () << "Failed to find required headers";
+
+        return false;
+    }
+
+    // Past the header only mapped columns are read; sources that decode lazily (CSV) skip the rest
+    source.setWantedColumns (mappedColumns (columnMapping));
+
+    parseAllRows (source, columnMapping, priceTags);
+
+
+    return true;
+}
+
+bool ExcelParser::quickZipSignatureCheck (const XlsxZipArchive &archive) const
+{
+    if (! archive.hasZipSignature ())
     {
         qDebug () << "Not a valid ZIP/OOXML (PK) signature";
 
@@ -83,10 +474,9 @@ bool ExcelParser::quickZipSignatureCheck (const QString &filePath) const
     return true;
 }
 
-bool ExcelParser::preScanZipForWorkbookAndSheets (const QString &filePath) const
+bool ExcelParser::preScanZipForWorkbookAndSheets (const XlsxZipArchive &archive) const
 {
-    QXlsx::ZipReader zr (filePath);
-    const auto files = zr.filePaths ();
+    const QStringList files = listArchiveEntries (archive);
 
     bool hasWorkbook	 = false;
     bool hasAnyWorksheet = false;
@@ -135,68 +525,75 @@ bool ExcelParser::readAndValidateDimension (QXlsx::Document &xlsx, QXlsx::CellRa
     return true;
 }
 
-void ExcelParser::parseAllRows (QXlsx::Document &xlsx, const QXlsx::CellRange &range, const ColumnMapping &mapping,
-                                QList<PriceTag> &priceTags) const
+void ExcelParser::parseAllRows (SheetRowSource &source, const ColumnMapping &mapping, QList<PriceTag> &priceTags)
 {
     QString currentSupplier;
     QString currentAddress;
 
-    int maxDataRow = findMaxDataRow (&xlsx, range, mapping);
+    // Repeating values (forward-filled supplier, brands, categories) share one allocation across tags
+    StringPool pool;
+
+    SheetRow row;
 
-    for (int row = 1; row <= maxDataRow; ++row)
+    // Trailing empty rows have neither brand nor price, parseDataRow skips them without a pre-scan
+    while (readNextRow (source, row))
     {
         PriceTag priceTag;
-        if (parseDataRow (&xlsx, row, mapping, currentSupplier, currentAddress, priceTag))
+        if (parseDataRow (row, mapping, pool, currentSupplier, currentAddress, priceTag))
         {
             if (validatePriceTag (priceTag))
             {
-                priceTags.append (priceTag);
+                if (tagSink)
+                {
+                    ++streamedTags;
+
+                    // The consumer gave up - stop the same way as a cancel
+                    if (! tagSink (priceTag))
+                    {
+                        cancelRequested = true;
 
-                qDebug () << "Added price tag:" << priceTag.getBrand () << priceTag.getCategory () << "Price:" << priceTag.getPrice ();
+                        return;
+                    }
+                }
+                else
+                    priceTags.append (priceTag);
             }
         }
     }
 }
 
 
-bool ExcelParser::findHeaders (QXlsx::Document *xlsx, const QXlsx::CellRange &range, ColumnMapping &mapping)
+bool ExcelParser::findHeaders (SheetRowSource &source, ColumnMapping &mapping)
 {
-    qDebug () << "Searching for headers in entire document...";
-
-    QMap<QString, int *> columnMap = buildHeaderColumnMap (mapping);
+    qDebug () << "Searching for header row...";
 
     resetColumnMapping (mapping);
 
+    const HeaderDictionary &dictionary = HeaderDictionary::instance ();
 
-    for (int row = range.firstRow (); row <= range.lastRow (); ++row)
-    {
-        for (int col = range.firstColumn (); col <= range.lastColumn (); ++col)
-        {
-            QVariant cellValue = xlsx->read (row, col);
-            if (cellValue.isValid ())
-            {
-                QString cellText		   = cellValue.toString ().trimmed ();
-                QString normalizedCellText = normalizeText (cellText);
+    SheetRow sheetRow;
+    bool headerRowFound = false;
+    int mappedColumns	= 0;
 
-                if (! cellText.isEmpty ())
-                {
-                    qDebug () << "Cell at row" << row << "col" << col << ":" << cellText;
-                    qDebug () << "Normalized:" << normalizedCellText;
 
-                    if (normalizedCellText.contains (QRegularExpression ("[\\x80-\\xFF]")))
-                    {
-                        qDebug () << "Contains encoding issues, trying to fix...";
+    while (! headerRowFound && readNextRow (source, sheetRow))
+    {
+        for (int col = 1; col < sheetRow.cells.size () && mappedColumns < HeaderDictionary::ColumnCount; ++col)
+        {
+            // Headers are always text; numeric and empty cells are skipped without conversion
+            const QVariant &cellValue = sheetRow.cell (col);
+            if (cellValue.userType () != QMetaType::QString)
+                continue;
 
-                        QByteArray bytes = cellText.toLocal8Bit ();
-                        QString decoded	 = QString::fromLocal8Bit (bytes);
+            if (tryAssignHeaderMatch (dictionary.lookup (normalizeText (cellValue.toString ())), col, mapping))
+                ++mappedColumns;
+        }
 
-                        qDebug () << "Decoded:" << decoded;
-                    }
-                }
+        // The row that completes the required columns is the header row; data starts right below it
+        headerRowFound = mapping.nameColumn != -1 && mapping.priceColumn != -1;
 
-                tryAssignHeaderMatch (normalizedCellText, col, columnMap);
-            }
-        }
+        if (headerRowFound)
+            qDebug () << "Header row:" << sheetRow.rowIndex << "mapped columns:" << mappedColumns;
     }
 
     if (mapping.nameColumn == -1 || mapping.priceColumn == -1)
@@ -213,42 +610,21 @@ bool ExcelParser::findHeaders (QXlsx::Document *xlsx, const QXlsx::CellRange &ra
     return true;
 }
 
-int ExcelParser::findMaxDataRow (QXlsx::Document *xlsx, const QXlsx::CellRange &range, const ColumnMapping &mapping) const
+bool ExcelParser::readNextRow (SheetRowSource &source, SheetRow &row)
 {
-    int maxRow = range.firstRow ();
-
-
-    for (int row = range.firstRow (); row <= range.lastRow (); ++row)
-    {
-        bool hasData = false;
-
-        if (mapping.nameColumn > 0)
-        {
-            QVariant cellValue = xlsx->read (row, mapping.nameColumn);
-
-            if (cellValue.isValid () && ! cellValue.toString ().trimmed ().isEmpty ())
-                hasData = true;
-        }
-
-        if (mapping.priceColumn > 0)
-        {
-            QVariant cellValue = xlsx->read (row, mapping.priceColumn);
-
-            if (cellValue.isValid () && ! cellValue.toString ().trimmed ().isEmpty ())
-                hasData = true;
-        }
+    if (cancelRequested || ! source.nextRow (row))
+        return false;
 
-        if (hasData)
-            maxRow = row;
-    }
+    // Throttled: a queued signal per row would flood the GUI thread
+    const qint64 done = ++rowsProcessed;
 
-    qDebug () << "Max data row found:" << maxRow;
+    if (done % progressRowStep == 0)
+        emit progressChanged (done, rowsEstimated);
 
 
-    return maxRow;
+    return true;
 }
 
-
 void ExcelParser::resetColumnMapping (ColumnMapping &mapping) const
 {
     mapping.nameColumn				 = -1;
@@ -267,71 +643,110 @@ void ExcelParser::resetColumnMapping (ColumnMapping &mapping) const
     mapping.price2Column			 = -1;
 }
 
-QMap<QString, int *> ExcelParser::buildHeaderColumnMap (ColumnMapping &mapping) const
+int *ExcelParser::columnSlot (ColumnMapping &mapping, HeaderDictionary::Column column) const
 {
-    return {{"Поставщик", &mapping.supplierColumn},
-            {"Адрес", &mapping.supplierAddressColumn},
-            {"Фирма", &mapping.nameColumn},
-            {"Категория", &mapping.categoryColumn},
-            {"Прочие данные", &mapping.additionalDataColumn},
-            {"Пол", &mapping.genderColumn},
-            {"Страна бренда", &mapping.brandCountryColumn},
-            {"Место производства", &mapping.manufacturingPlaceColumn},
-            {"Материал", &mapping.materialColumn},
-            {"Размер", &mapping.sizeColumn},
-            {"Артикул", &mapping.articleColumn},
-            {"Цена", &mapping.priceColumn},
-            {"Цена 2", &mapping.price2Column},
-            {"Количество", &mapping.quantityColumn}};
+    switch (column)
+    {
+        case HeaderDictionary::Supplier:
+            return &mapping.supplierColumn;
+        case HeaderDictionary::Address:
+            return &mapping.supplierAddressColumn;
+        case HeaderDictionary::Name:
+            return &mapping.nameColumn;
+        case HeaderDictionary::Category:
+            return &mapping.categoryColumn;
+        case HeaderDictionary::AdditionalData:
+            return &mapping.additionalDataColumn;
+        case HeaderDictionary::Gender:
+            return &mapping.genderColumn;
+        case HeaderDictionary::BrandCountry:
+            return &mapping.brandCountryColumn;
+        case HeaderDictionary::ManufacturingPlace:
+            return &mapping.manufacturingPlaceColumn;
+        case HeaderDictionary::Material:
+            return &mapping.materialColumn;
+        case HeaderDictionary::Size:
+            return &mapping.sizeColumn;
+        case HeaderDictionary::Article:
+            return &mapping.articleColumn;
+        case HeaderDictionary::Price:
+            return &mapping.priceColumn;
+        case HeaderDictionary::Price2:
+            return &mapping.price2Column;
+        case HeaderDictionary::Quantity:
+            return &mapping.quantityColumn;
+        case HeaderDictionary::Unknown:
+            break;
+    }
+
+
+    return nullptr;
 }
 
-void ExcelParser::tryAssignHeaderMatch (const QString &normalizedCellText, int col, const QMap<QString, int *> &columnMap) const
+QVector<int> ExcelParser::mappedColumns (ColumnMapping &mapping) const
 {
-    for (auto it = columnMap.begin (); it != columnMap.end (); ++it)
+    QVector<int> columns;
+
+    for (int column = 0; column < HeaderDictionary::ColumnCount; ++column)
     {
-        QString expectedHeader = it.key ();
+        const int *slot = columnSlot (mapping, HeaderDictionary::Column (column));
 
-        if (normalizedCellText.compare (expectedHeader, Qt::CaseInsensitive) == 0)
-        {
-            *(it.value ()) = col;
+        if (slot && *slot > 0)
+            columns.append (*slot);
+    }
 
-            qDebug () << "Found header '" << expectedHeader << "' at column" << col;
 
-            break;
-        }
-    }
+    return columns;
 }
 
-bool ExcelParser::parseDataRow (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, QString &currentSupplier,
+bool ExcelParser::tryAssignHeaderMatch (HeaderDictionary::Column column, int col, ColumnMapping &mapping) const
+{
+    int *slot = columnSlot (mapping, column);
+    if (! slot)
+        return false;
+
+    // First match wins: with aliases, a later column of the same kind (e.g. «Бренд» after «Фирма») must not move it
+    if (*slot != -1)
+        return false;
+
+    *slot = col;
+
+    qDebug () << "Found header" << column << "at column" << col;
+
+
+    return true;
+}
+
+bool ExcelParser::parseDataRow (const SheetRow &row, const ColumnMapping &mapping, StringPool &pool, QString &currentSupplier,
                                 QString &currentAddress, PriceTag &priceTag) const
 {
     bool hasData = false;
 
-    if (parseBrand (xlsx, row, mapping, priceTag))
+    if (parseBrand (row, mapping, pool, priceTag))
         hasData = true;
 
-    if (parsePrice (xlsx, row, mapping, priceTag))
+    if (parsePrice (row, mapping, priceTag))
         hasData = true;
 
     if (! hasData)
         return false;
 
 
-    parseQuantity (xlsx, row, mapping, priceTag);
-    updateSupplierAndAddress (xlsx, row, mapping, currentSupplier, currentAddress, priceTag);
-    parseAttributes (xlsx, row, mapping, priceTag);
+    parseQuantity (row, mapping, priceTag);
+    updateSupplierAndAddress (row, mapping, pool, currentSupplier, currentAddress, priceTag);
+    parseAttributes (row, mapping, pool, priceTag);
 
 
     return true;
 }
 
 
-bool ExcelParser::readTrimmedStringFromCell (QXlsx::Document *xlsx, int row, int col, QString &out) const
+bool ExcelParser::readTrimmedStringFromCell (const SheetRow &row, int col, QString &out) const
 {
     if (col <= 0)
         return false;
 
-    QVariant cellValue = xlsx->read (row, col);
+    const QVariant &cellValue = row.cell (col);
     if (! cellValue.isValid ())
         return false;
 
@@ -345,41 +760,22 @@ bool ExcelParser::readTrimmedStringFromCell (QXlsx::Document *xlsx, int row, int
     return true;
 }
 
-bool ExcelParser::readPositiveDoubleFromCell (QXlsx::Document *xlsx, int row, int col, double &out) const
+bool ExcelParser::readPositiveDoubleFromCell (const SheetRow &row, int col, double &out) const
 {
     if (col <= 0)
         return false;
 
-    QVariant cellValue = xlsx->read (row, col);
-    if (! cellValue.isValid ())
-        return false;
-
-    QString priceStr = cellValue.toString ().trimmed ();
-    if (priceStr.isEmpty ())
-        return false;
-
-    priceStr.remove (QRegularExpression ("[^0-9.,]"));
-    priceStr.replace (",", ".");
-
-    double value = priceStr.toDouble ();
-    if (value > 0)
-    {
-        out = value;
-
-        return true;
-    }
-
 
-    return false;
+    return NumericScanner::readPositive (row.cell (col), out);
 }
 
-bool ExcelParser::parseBrand (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, PriceTag &priceTag) const
+bool ExcelParser::parseBrand (const SheetRow &row, const ColumnMapping &mapping, StringPool &pool, PriceTag &priceTag) const
 {
     QString brand;
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.nameColumn, brand))
+    if (readTrimmedStringFromCell (row, mapping.nameColumn, brand))
     {
-        priceTag.setBrand (brand);
+        priceTag.setBrand (pool.intern (brand));
 
         return true;
     }
@@ -388,11 +784,11 @@ bool ExcelParser::parseBrand (QXlsx::Document *xlsx, int row, const ColumnMappin
     return false;
 }
 
-bool ExcelParser::parsePrice (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, PriceTag &priceTag) const
+bool ExcelParser::parsePrice (const SheetRow &row, const ColumnMapping &mapping, PriceTag &priceTag) const
 {
     double priceValue = 0.0;
 
-    if (readPositiveDoubleFromCell (xlsx, row, mapping.priceColumn, priceValue))
+    if (readPositiveDoubleFromCell (row, mapping.priceColumn, priceValue))
     {
         priceTag.setPrice (priceValue);
 
@@ -403,13 +799,13 @@ bool ExcelParser::parsePrice (QXlsx::Document *xlsx, int row, const ColumnMappin
     return false;
 }
 
-void ExcelParser::parseQuantity (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, PriceTag &priceTag) const
+void ExcelParser::parseQuantity (const SheetRow &row, const ColumnMapping &mapping, PriceTag &priceTag) const
 {
     priceTag.setQuantity (1);
 
     if (mapping.quantityColumn > 0)
     {
-        QVariant cellValue = xlsx->read (row, mapping.quantityColumn);
+        const QVariant &cellValue = row.cell (mapping.quantityColumn);
         if (cellValue.isValid ())
         {
             bool ok;
@@ -426,56 +822,56 @@ void ExcelParser::parseQuantity (QXlsx::Document *xlsx, int row, const ColumnMap
 }
 
 
-void ExcelParser::updateSupplierAndAddress (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, QString &currentSupplier,
+void ExcelParser::updateSupplierAndAddress (const SheetRow &row, const ColumnMapping &mapping, StringPool &pool, QString &currentSupplier,
                                             QString &currentAddress, PriceTag &priceTag) const
 {
     QString supplier;
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.supplierColumn, supplier))
-        currentSupplier = supplier;
+    if (readTrimmedStringFromCell (row, mapping.supplierColumn, supplier))
+        currentSupplier = pool.intern (supplier);
 
     priceTag.setSupplier (currentSupplier);
 
 
     QString address;
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.supplierAddressColumn, address))
-        currentAddress = address;
+    if (readTrimmedStringFromCell (row, mapping.supplierAddressColumn, address))
+        currentAddress = pool.intern (address);
 
     priceTag.setAddress (currentAddress);
 }
 
-void ExcelParser::parseAttributes (QXlsx::Document *xlsx, int row, const ColumnMapping &mapping, PriceTag &priceTag) const
+void ExcelParser::parseAttributes (const SheetRow &row, const ColumnMapping &mapping, StringPool &pool, PriceTag &priceTag) const
 {
     QString textValue;
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.categoryColumn, textValue))
-        priceTag.setCategory (textValue);
+    if (readTrimmedStringFromCell (row, mapping.categoryColumn, textValue))
+        priceTag.setCategory (pool.intern (textValue));
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.additionalDataColumn, textValue))
+    if (readTrimmedStringFromCell (row, mapping.additionalDataColumn, textValue))
         priceTag.setAdditionalData (textValue);
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.genderColumn, textValue))
-        priceTag.setGender (textValue);
+    if (readTrimmedStringFromCell (row, mapping.genderColumn, textValue))
+        priceTag.setGender (pool.intern (textValue));
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.brandCountryColumn, textValue))
-        priceTag.setBrandCountry (textValue);
+    if (readTrimmedStringFromCell (row, mapping.brandCountryColumn, textValue))
+        priceTag.setBrandCountry (pool.intern (textValue));
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.manufacturingPlaceColumn, textValue))
-        priceTag.setManufacturingPlace (textValue);
+    if (readTrimmedStringFromCell (row, mapping.manufacturingPlaceColumn, textValue))
+        priceTag.setManufacturingPlace (pool.intern (textValue));
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.materialColumn, textValue))
-        priceTag.setMaterial (textValue);
+    if (readTrimmedStringFromCell (row, mapping.materialColumn, textValue))
+        priceTag.setMaterial (pool.intern (textValue));
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.sizeColumn, textValue))
-        priceTag.setSize (textValue);
+    if (readTrimmedStringFromCell (row, mapping.sizeColumn, textValue))
+        priceTag.setSize (pool.intern (textValue));
 
-    if (readTrimmedStringFromCell (xlsx, row, mapping.articleColumn, textValue))
+    if (readTrimmedStringFromCell (row, mapping.articleColumn, textValue))
         priceTag.setArticle (textValue);
 
 
     double price2Value = 0.0;
-    if (readPositiveDoubleFromCell (xlsx, row, mapping.price2Column, price2Value))
+    if (readPositiveDoubleFromCell (row, mapping.price2Column, price2Value))
         priceTag.setPrice2 (price2Value);
 }
 
@@ -489,7 +885,7 @@ bool ExcelParser::validatePriceTag (const PriceTag &priceTag) const
         return false;
     }
 
-    if (priceTag.getPrice () <= 0)
+    if (! priceTag.getPriceMoney ().isPositive ())
     {
         qDebug () << "Price tag validation failed: invalid price" << priceTag.getPrice ();
 
@@ -507,20 +903,29 @@ bool ExcelParser::validatePriceTag (const PriceTag &priceTag) const
     return true;
 }
 
-QString ExcelParser::normalizeText (const QString &text)
+QString ExcelParser::normalizeText (const QString &text) const
 {
-    QString normalized = text;
+    QString normalized = text.simplified ();
+
+    int begin = 0;
+    int end	  = normalized.size ();
+
+    while (begin < end && (normalized.at (begin) == QLatin1Char ('"') || normalized.at (begin) == QLatin1Char ('\'')))
+        ++begin;
+
+    while (end > begin && (normalized.at (end - 1) == QLatin1Char ('"') || normalized.at (end - 1) == QLatin1Char ('\'')))
+        --end;
 
-    normalized = normalized.simplified ();
-    normalized = normalized.remove (QRegularExpression ("^[\"']+|[\"']+$"));
+    if (begin > 0 || end < normalized.size ())
+        normalized = normalized.mid (begin, end - begin);
 
 
-    if (normalized.contains (QRegularExpression ("[\\x80-\\xFF]")))
+    // Latin-1 range characters usually mean text decoded with the wrong code page
+    if (hasLatin1RangeChars (normalized))
     {
-        QByteArray bytes = normalized.toLocal8Bit ();
-        QString decoded	 = QString::fromLocal8Bit (bytes);
+        const QString decoded = QString::fromLocal8Bit (normalized.toLocal8Bit ());
 
-        if (! decoded.contains (QRegularExpression ("[\\x80-\\xFF]")))
+        if (! hasLatin1RangeChars (decoded))
             normalized = decoded;
     }
 
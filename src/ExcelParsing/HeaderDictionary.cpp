@@ -0,0 +1,193 @@
+#include "HeaderDictionary.h"
+
+
+namespace
+{
+    struct HeaderAlias
+    {
+        const char *text; // UTF-8
+        HeaderDictionary::Column column;
+    };
+
+
+    // Only unambiguous names: «Стоимость» or «Сумма» usually head a line total next to «Цена», and a generic
+    // «Дополнительно» sits beside «Прочие данные». Several aliases of one column in a row map the leftmost one.
+    const HeaderAlias headerAliases[] = {
+            {"Поставщик", HeaderDictionary::Supplier},
+            {"Поставщики", HeaderDictionary::Supplier},
+            {"Supplier", HeaderDictionary::Supplier},
+            {"Vendor", HeaderDictionary::Supplier},
+
+            {"Адрес", HeaderDictionary::Address},
+            {"Адрес поставщика", HeaderDictionary::Address},
+            {"Address", HeaderDictionary::Address},
+
+            {"Фирма", HeaderDictionary::Name},
+            {"Бренд", HeaderDictionary::Name},
+            {"Марка", HeaderDictionary::Name},
+            {"Brand", HeaderDictionary::Name},
+
+            {"Категория", HeaderDictionary::Category},
+            {"Category", HeaderDictionary::Category},
+
+            {"Прочие данные", HeaderDictionary::AdditionalData},
+            {"Доп. данные", HeaderDictionary::AdditionalData},
+            {"Additional data", HeaderDictionary::AdditionalData},
+            {"Notes", HeaderDictionary::AdditionalData},
+
+            {"Пол", HeaderDictionary::Gender},
+            {"Gender", HeaderDictionary::Gender},
+
+            {"Страна бренда", HeaderDictionary::BrandCountry},
+            {"Страна марки", HeaderDictionary::BrandCountry},
+            {"Brand country", HeaderDictionary::BrandCountry},
+
+            {"Место производства", HeaderDictionary::ManufacturingPlace},
+            {"Страна производства", HeaderDictionary::ManufacturingPlace},
+            {"Country of origin", HeaderDictionary::ManufacturingPlace},
+            {"Made in", HeaderDictionary::ManufacturingPlace},
+
+            {"Материал", HeaderDictionary::Material},
+            {"Состав", HeaderDictionary::Material},
+            {"Material", HeaderDictionary::Material},
+
+            {"Размер", HeaderDictionary::Size},
+            {"Размеры", HeaderDictionary::Size},
+            {"Size", HeaderDictionary::Size},
+
+            {"Артикул", HeaderDictionary::Article},
+            {"Арт.", HeaderDictionary::Article},
+            {"Article", HeaderDictionary::Article},
+            {"SKU", HeaderDictionary::Article},
+
+            {"Цена", HeaderDictionary::Price},
+            {"Price", HeaderDictionary::Price},
+
+            {"Цена 2", HeaderDictionary::Price2},
+            {"Цена2", HeaderDictionary::Price2},
+            {"Цена со скидкой", HeaderDictionary::Price2},
+            {"Price 2", HeaderDictionary::Price2},
+            {"Sale price", HeaderDictionary::Price2},
+
+            {"Количество", HeaderDictionary::Quantity},
+            {"Кол-во", HeaderDictionary::Quantity},
+            {"Quantity", HeaderDictionary::Quantity},
+            {"Qty", HeaderDictionary::Quantity},
+    };
+
+
+    // FNV-1a over case-folded UTF-16 code units, so lookups never allocate a folded copy
+    quint32 foldedHash (QStringView text, quint32 seed)
+    {
+        quint32 h = 2166136261u ^ seed;
+
+        for (const QChar ch : text)
+        {
+            h ^= ch.toCaseFolded ().unicode ();
+            h *= 16777619u;
+        }
+
+
+        return h;
+    }
+
+    bool foldedEquals (QStringView text, const QString &foldedKey)
+    {
+        if (text.size () != foldedKey.size ())
+            return false;
+
+        for (int i = 0; i < foldedKey.size (); ++i)
+        {
+            if (text.at (i).toCaseFolded () != foldedKey.at (i))
+                return false;
+        }
+
+
+        return true;
+    }
+} // namespace
+
+
+const HeaderDictionary &HeaderDictionary::instance ()
+{
+    static const HeaderDictionary dictionary;
+
+
+    return dictionary;
+}
+
+
+HeaderDictionary::HeaderDictionary ()
+{
+    QVector<Entry> keys;
+    keys.reserve (int (sizeof (headerAliases) / sizeof (headerAliases[0])));
+
+    for (const HeaderAlias &alias : headerAliases)
+    {
+        Entry entry;
+
+        entry.key	 = QString::fromUtf8 (alias.text).toCaseFolded ();
+        entry.column = alias.column;
+
+        maxKeyLength = qMax (maxKeyLength, int (entry.key.size ()));
+        keys.append (entry);
+    }
+
+
+    // Seed search: with a table at least four times the key count a collision-free seed turns up within a few tries
+    int tableSize = 1;
+    while (tableSize < keys.size () * 4)
+        tableSize <<= 1;
+
+    for (;;)
+    {
+        for (quint32 candidate = 0; candidate < 10000; ++candidate)
+        {
+            if (tryBuild (keys, tableSize, candidate))
+                return;
+        }
+
+        tableSize <<= 1;
+    }
+}
+
+bool HeaderDictionary::tryBuild (const QVector<Entry> &keys, int tableSize, quint32 candidateSeed)
+{
+    const quint32 candidateMask = quint32 (tableSize - 1);
+
+    QVector<bool> used (tableSize, false);
+
+
+    for (const Entry &entry : keys)
+    {
+        const int index = int (foldedHash (entry.key, candidateSeed) & candidateMask);
+
+        if (used.at (index))
+            return false;
+
+        used[index] = true;
+    }
+
+    seed = candidateSeed;
+    mask = candidateMask;
+
+    table.fill (Entry (), tableSize);
+
+    for (const Entry &entry : keys)
+        table[int (foldedHash (entry.key, seed) & mask)] = entry;
+
+
+    return true;
+}
+
+
+HeaderDictionary::Column HeaderDictionary::lookup (QStringView text) const
+{
+    if (text.isEmpty () || text.size () > maxKeyLength)
+        return Unknown;
+
+    const Entry &entry = table.at (int (foldedHash (text, seed) & mask));
+
+
+    return (entry.column != Unknown && foldedEquals (text, entry.key)) ? entry.column : Unknown;
+}
@@ -0,0 +1,158 @@
+#include "NumericScanner.h"
+
+#include <QString>
+#include <cmath>
+
+
+namespace
+{
+    // Mantissas up to 15 digits stay exact in a double, so mantissa / 10^n rounds like toDouble does
+    const int maxExactDigits = 15;
+
+    const double powersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+
+    bool isDigit (QChar ch) { return ch.unicode () >= '0' && ch.unicode () <= '9'; }
+
+    bool isSeparator (QChar ch) { return ch.unicode () == '.' || ch.unicode () == ','; }
+
+    double powerOfTen (int exponent)
+    {
+        return exponent < int (sizeof (powersOfTen) / sizeof (powersOfTen[0])) ? powersOfTen[exponent] : std::pow (10.0, exponent);
+    }
+
+
+    // Only a separator directly followed by a digit takes part in the number, so "руб." or "шт." never does.
+    // One separator is decimal, the same one repeated is grouping, with both kinds present the last one is decimal.
+    int findDecimalSeparator (QStringView text)
+    {
+        int dots		  = 0;
+        int commas		  = 0;
+        int lastSeparator = -1;
+
+
+        for (int i = 0; i + 1 < text.size (); ++i)
+        {
+            if (! isSeparator (text.at (i)) || ! isDigit (text.at (i + 1)))
+                continue;
+
+            if (text.at (i).unicode () == '.')
+                ++dots;
+            else
+                ++commas;
+
+            lastSeparator = i;
+        }
+
+        if (lastSeparator < 0)
+            return -1;
+
+        const bool lastIsDot  = text.at (lastSeparator).unicode () == '.';
+        const int sameKind	  = lastIsDot ? dots : commas;
+        const int otherKind	  = lastIsDot ? commas : dots;
+
+
+        return (otherKind > 0 || sameKind == 1) ? lastSeparator : -1;
+    }
+} // namespace
+
+
+bool NumericScanner::scanNumber (QStringView text, double &out)
+{
+    const int decimalPos = findDecimalSeparator (text);
+
+    quint64 mantissa	 = 0;
+    int significant		 = 0;
+    int fractionDigits	 = 0;
+    int droppedIntDigits = 0;
+    bool inFraction		 = false;
+    bool anyDigit		 = false;
+
+
+    // Spaces, NBSP, currency signs and letters are simply not digits and fall through
+    for (int i = 0; i < text.size (); ++i)
+    {
+        if (i == decimalPos)
+        {
+            inFraction = true;
+
+            continue;
+        }
+
+        const QChar ch = text.at (i);
+        if (! isDigit (ch))
+            continue;
+
+        anyDigit = true;
+
+        if (significant < maxExactDigits)
+        {
+            mantissa = mantissa * 10 + (ch.unicode () - '0');
+
+            if (mantissa != 0)
+                ++significant;
+
+            if (inFraction)
+                ++fractionDigits;
+        }
+        else if (! inFraction)
+            ++droppedIntDigits;
+    }
+
+    if (! anyDigit)
+        return false;
+
+    double value = double (mantissa);
+
+    if (fractionDigits > 0)
+        value /= powerOfTen (fractionDigits);
+
+    if (droppedIntDigits > 0)
+        value *= powerOfTen (droppedIntDigits);
+
+    out = value;
+
+
+    return true;
+}
+
+bool NumericScanner::readPositive (const QVariant &value, double &out)
+{
+    double number = 0.0;
+
+
+    switch (value.userType ())
+    {
+        case QMetaType::Double:
+        case QMetaType::Float:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+            number = value.toDouble ();
+            break;
+
+        case QMetaType::UnknownType:
+            return false;
+
+        default:
+        {
+            // Copy of a string variant shares its data, nothing is allocated here
+            const QString text = value.toString ();
+
+            if (! scanNumber (text, number))
+                return false;
+
+            break;
+        }
+    }
+
+    if (! (number > 0))
+        return false;
+
+    out = number;
+
+
+    return true;
+}
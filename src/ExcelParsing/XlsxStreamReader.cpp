@@ -0,0 +1,439 @@
+#include "XlsxStreamReader.h"
+
+#include <QDebug>
+#include <QIODevice>
+#include <QStringView>
+#include <QXmlStreamReader>
+
+
+namespace
+{
+    const QString workbookPath			= QStringLiteral ("xl/workbook.xml");
+    const QString workbookRelsPath		= QStringLiteral ("xl/_rels/workbook.xml.rels");
+    const QString defaultSharedStrings	= QStringLiteral ("xl/sharedStrings.xml");
+    const int maxSharedStringsReserve	= 1 << 20;
+
+
+    // Relationship targets are relative to xl/ unless they are package-absolute
+    QString resolvePartPath (const QString &target)
+    {
+        if (target.startsWith (QLatin1Char ('/')))
+            return target.mid (1);
+
+        QString path = QStringLiteral ("xl/") + target;
+
+        while (path.contains (QLatin1String ("/../")))
+        {
+            const int up	 = path.indexOf (QLatin1String ("/../"));
+            const int parent = path.lastIndexOf (QLatin1Char ('/'), up - 1);
+
+            path.remove (parent + 1, up + 4 - (parent + 1));
+        }
+
+
+        return path;
+    }
+
+    // "BC12" -> 55; returns 0 when the reference has no column letters
+    int columnFromReference (QStringView ref)
+    {
+        int col = 0;
+
+        for (const QChar ch : ref)
+        {
+            const ushort u = ch.unicode ();
+
+            if (u >= 'A' && u <= 'Z')
+                col = col * 26 + (u - 'A' + 1);
+            else if (u >= 'a' && u <= 'z')
+                col = col * 26 + (u - 'a' + 1);
+            else
+                break;
+        }
+
+
+        return col;
+    }
+
+    // "A1:N5000" -> 5000, "B7" -> 7; 0 when there is no row number
+    int rowFromReference (const QString &ref)
+    {
+        const int colon		= ref.lastIndexOf (QLatin1Char (':'));
+        const QString last	= ref.mid (colon + 1);
+        int digitsFrom		= 0;
+
+        while (digitsFrom < last.size () && ! last.at (digitsFrom).isDigit ())
+            ++digitsFrom;
+
+
+        return last.mid (digitsFrom).toInt ();
+    }
+
+    QString localAttribute (const QXmlStreamAttributes &attrs, QLatin1String name)
+    {
+        for (const QXmlStreamAttribute &a : attrs)
+        {
+            if (a.name () == name)
+                return a.value ().toString ();
+        }
+
+
+        return QString ();
+    }
+
+    // Concatenates every <t> of a string item, including rich text runs; phonetic hints are skipped
+    QString readStringItem (QXmlStreamReader &xml)
+    {
+        QString text;
+
+        while (xml.readNextStartElement ())
+        {
+            if (xml.name () == QLatin1String ("t"))
+                text += xml.readElementText ();
+            else if (xml.name () == QLatin1String ("r"))
+            {
+                while (xml.readNextStartElement ())
+                {
+                    if (xml.name () == QLatin1String ("t"))
+                        text += xml.readElementText ();
+                    else
+                        xml.skipCurrentElement ();
+                }
+            }
+            else
+                xml.skipCurrentElement ();
+        }
+
+
+        return text;
+    }
+} // namespace
+
+
+// ====================================================== XlsxStreamWorkbook ======================================================
+
+XlsxStreamWorkbook::XlsxStreamWorkbook (const XlsxZipArchive &archive) : zip (archive) {}
+
+
+bool XlsxStreamWorkbook::load ()
+{
+    if (! zip.isValid () || ! zip.contains (workbookPath))
+        return false;
+
+    QString sharedStringsPath;
+    const QHash<QString, QString> worksheetTargets = readWorkbookRelationships (sharedStringsPath);
+
+    if (! readWorkbook (worksheetTargets))
+        return false;
+
+    if (zip.contains (sharedStringsPath) && ! readSharedStrings (sharedStringsPath))
+        return false;
+
+    qDebug () << "Streaming workbook:" << sheets.size () << "sheets," << strings.size () << "shared strings";
+
+
+    return ! sheets.isEmpty ();
+}
+
+
+QString XlsxStreamWorkbook::sheetName (int index) const
+{
+    return (index >= 0 && index < sheets.size ()) ? sheets.at (index).name : QString ();
+}
+
+QString XlsxStreamWorkbook::sheetPath (int index) const
+{
+    return (index >= 0 && index < sheets.size ()) ? sheets.at (index).path : QString ();
+}
+
+
+QHash<QString, QString> XlsxStreamWorkbook::readWorkbookRelationships (QString &sharedStringsPath) const
+{
+    QHash<QString, QString> worksheetTargets;
+    sharedStringsPath = defaultSharedStrings;
+
+    QXmlStreamReader xml (zip.fileData (workbookRelsPath));
+
+
+    while (! xml.atEnd ())
+    {
+        xml.readNext ();
+
+        if (! xml.isStartElement () || xml.name () != QLatin1String ("Relationship"))
+            continue;
+
+        const QXmlStreamAttributes attrs = xml.attributes ();
+        const QString type				 = localAttribute (attrs, QLatin1String ("Type"));
+        const QString target			 = resolvePartPath (localAttribute (attrs, QLatin1String ("Target")));
+
+        if (type.endsWith (QLatin1String ("/worksheet")))
+            worksheetTargets.insert (localAttribute (attrs, QLatin1String ("Id")), target);
+        else if (type.endsWith (QLatin1String ("/sharedStrings")))
+            sharedStringsPath = target;
+    }
+
+
+    return worksheetTargets;
+}
+
+bool XlsxStreamWorkbook::readWorkbook (const QHash<QString, QString> &worksheetTargets)
+{
+    QXmlStreamReader xml (zip.fileData (workbookPath));
+
+
+    while (! xml.atEnd ())
+    {
+        xml.readNext ();
+
+        if (! xml.isStartElement ())
+            continue;
+
+        if (xml.name () == QLatin1String ("workbookView"))
+        {
+            bool ok		   = false;
+            const int active = localAttribute (xml.attributes (), QLatin1String ("activeTab")).toInt (&ok);
+
+            if (ok && active >= 0)
+                activeSheet = active;
+        }
+        else if (xml.name () == QLatin1String ("sheet"))
+        {
+            const QXmlStreamAttributes attrs = xml.attributes ();
+            SheetEntry entry;
+
+            entry.name = localAttribute (attrs, QLatin1String ("name"));
+            entry.path = worksheetTargets.value (localAttribute (attrs, QLatin1String ("id")));
+
+            sheets.append (entry);
+        }
+    }
+
+    if (xml.hasError ())
+    {
+        qDebug () << "Failed to read workbook.xml:" << xml.errorString ();
+
+        return false;
+    }
+
+    if (activeSheet >= sheets.size ())
+        activeSheet = 0;
+
+
+    return true;
+}
+
+bool XlsxStreamWorkbook::readSharedStrings (const QString &path)
+{
+    QScopedPointer<QIODevice> device (zip.openEntry (path));
+    if (! device)
+        return false;
+
+    QXmlStreamReader xml (device.data ());
+
+
+    while (! xml.atEnd ())
+    {
+        xml.readNext ();
+
+        if (! xml.isStartElement ())
+            continue;
+
+        if (xml.name () == QLatin1String ("sst"))
+        {
+            const int unique = localAttribute (xml.attributes (), QLatin1String ("uniqueCount")).toInt ();
+
+            if (unique > 0)
+                strings.reserve (qMin (unique, maxSharedStringsReserve));
+        }
+        else if (xml.name () == QLatin1String ("si"))
+            strings.append (readStringItem (xml));
+    }
+
+    if (xml.hasError ())
+    {
+        qDebug () << "Failed to read shared strings:" << xml.errorString ();
+
+        return false;
+    }
+
+
+    return true;
+}
+
+
+// ====================================================== XlsxSheetReader =========================================================
+
+XlsxSheetReader::XlsxSheetReader (const XlsxStreamWorkbook &workbook, int sheetIndex) : workbook (workbook), sheetIndex (sheetIndex) {}
+
+XlsxSheetReader::~XlsxSheetReader () {}
+
+
+bool XlsxSheetReader::open ()
+{
+    xml.reset ();
+    device.reset (workbook.archive ().openEntry (workbook.sheetPath (sheetIndex)));
+
+    if (! device)
+    {
+        qDebug () << "Worksheet part not found for sheet" << sheetIndex;
+
+        return false;
+    }
+
+    xml.reset (new QXmlStreamReader (device.data ()));
+    lastRowIndex  = 0;
+    dimensionRows = 0;
+
+
+    // Skip sheet properties, column widths etc. up to the cell data; <dimension ref="A1:N5000"> gives the row estimate
+    while (! xml->atEnd ())
+    {
+        xml->readNext ();
+
+        if (! xml->isStartElement ())
+            continue;
+
+        if (xml->name () == QLatin1String ("dimension"))
+            dimensionRows = rowFromReference (localAttribute (xml->attributes (), QLatin1String ("ref")));
+        else if (xml->name () == QLatin1String ("sheetData"))
+            return true;
+    }
+
+
+    return false;
+}
+
+bool XlsxSheetReader::nextRow (SheetRow &row)
+{
+    if (! xml)
+        return false;
+
+
+    while (! xml->atEnd ())
+    {
+        xml->readNext ();
+
+        if (xml->isStartElement () && xml->name () == QLatin1String ("row"))
+            return readRow (row);
+
+        if (xml->isEndElement () && xml->name () == QLatin1String ("sheetData"))
+            break;
+    }
+
+    if (xml->hasError ())
+        qDebug () << "Worksheet XML error:" << xml->errorString ();
+
+
+    return false;
+}
+
+
+bool XlsxSheetReader::readRow (SheetRow &row)
+{
+    bool ok			  = false;
+    const int rowAttr = localAttribute (xml->attributes (), QLatin1String ("r")).toInt (&ok);
+
+    row.rowIndex = (ok && rowAttr > 0) ? rowAttr : lastRowIndex + 1;
+    lastRowIndex = row.rowIndex;
+
+    row.cells.clear ();
+    int nextCol = 1;
+
+
+    while (xml->readNextStartElement ())
+    {
+        if (xml->name () != QLatin1String ("c"))
+        {
+            xml->skipCurrentElement ();
+
+            continue;
+        }
+
+        const QXmlStreamAttributes attrs = xml->attributes ();
+        const QString typeAttr			 = localAttribute (attrs, QLatin1String ("t"));
+
+        int col = columnFromReference (localAttribute (attrs, QLatin1String ("r")));
+        if (col <= 0)
+            col = nextCol;
+
+        nextCol = col + 1;
+
+
+        CellType type = CellType::Number;
+
+        if (typeAttr == QLatin1String ("s"))
+            type = CellType::SharedString;
+        else if (typeAttr == QLatin1String ("inlineStr"))
+            type = CellType::InlineString;
+        else if (typeAttr == QLatin1String ("str") || typeAttr == QLatin1String ("e"))
+            type = CellType::String;
+        else if (typeAttr == QLatin1String ("b"))
+            type = CellType::Boolean;
+
+
+        const QVariant value = readCellValue (type);
+        if (! value.isValid ())
+            continue;
+
+        if (row.cells.size () <= col)
+            row.cells.resize (col + 1);
+
+        row.cells[col] = value;
+    }
+
+
+    return ! xml->hasError ();
+}
+
+QVariant XlsxSheetReader::readCellValue (CellType type)
+{
+    QString text;
+    bool hasValue = false;
+
+
+    while (xml->readNextStartElement ())
+    {
+        if (xml->name () == QLatin1String ("v"))
+        {
+            text	 = xml->readElementText ();
+            hasValue = true;
+        }
+        else if (xml->name () == QLatin1String ("is"))
+        {
+            text	 = readStringItem (*xml);
+            hasValue = true;
+        }
+        else
+            xml->skipCurrentElement ();
+    }
+
+    if (! hasValue)
+        return QVariant ();
+
+
+    switch (type)
+    {
+        case CellType::SharedString:
+        {
+            bool ok			= false;
+            const int index = text.toInt (&ok);
+            const QVector<QString> &shared = workbook.sharedStrings ();
+
+            return (ok && index >= 0 && index < shared.size ()) ? QVariant (shared.at (index)) : QVariant ();
+        }
+        case CellType::InlineString:
+        case CellType::String:
+            return QVariant (text);
+        case CellType::Boolean:
+            return QVariant (text == QLatin1String ("1"));
+        case CellType::Number:
+            break;
+    }
+
+
+    bool ok			   = false;
+    const double number = text.toDouble (&ok);
+
+
+    return ok ? QVariant (number) : QVariant (text);
+}
@@ -0,0 +1,334 @@
+#include "XlsxZipArchive.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QIODevice>
+#include <QtEndian>
+#include <limits>
+
+#include <zlib.h>
+
+
+namespace
+{
+    const quint32 endOfCentralDirSignature = 0x06054b50;
+    const quint32 centralHeaderSignature   = 0x02014b50;
+    const quint32 localHeaderSignature	   = 0x04034b50;
+
+    const int endOfCentralDirSize = 22;
+    const int centralHeaderSize	  = 46;
+    const int localHeaderSize	  = 30;
+    const int maxCommentSize	  = 0xFFFF;
+
+    const quint16 methodStored	 = 0;
+    const quint16 methodDeflated = 8;
+
+
+    quint16 readU16 (const char *p) { return qFromLittleEndian<quint16> (p); }
+
+    quint32 readU32 (const char *p) { return qFromLittleEndian<quint32> (p); }
+
+
+    // Sequential device inflating one entry directly from the mapped archive; holds only the inflate state
+    class InflateEntryDevice: public QIODevice
+    {
+    public:
+        InflateEntryDevice (const char *compressed, quint32 compressedSize) : compressed (compressed), compressedSize (compressedSize)
+        {}
+
+        ~InflateEntryDevice () override { close (); }
+
+
+        bool open (OpenMode mode) override
+        {
+            if (mode & QIODevice::WriteOnly)
+                return false;
+
+            // Negative window bits: raw deflate stream without zlib header, as stored in ZIP
+            if (inflateInit2 (&stream, -MAX_WBITS) != Z_OK)
+                return false;
+
+            streamInitialized = true;
+
+            stream.next_in	= reinterpret_cast<Bytef *> (const_cast<char *> (compressed));
+            stream.avail_in = compressedSize;
+
+
+            return QIODevice::open (mode);
+        }
+
+        void close () override
+        {
+            if (streamInitialized)
+            {
+                inflateEnd (&stream);
+                streamInitialized = false;
+            }
+
+            QIODevice::close ();
+        }
+
+        bool isSequential () const override { return true; }
+
+        bool atEnd () const override { return finished && QIODevice::bytesAvailable () == 0; }
+
+        qint64 bytesAvailable () const override { return QIODevice::bytesAvailable () + (finished ? 0 : 1); }
+
+
+    protected:
+        qint64 readData (char *data, qint64 maxSize) override
+        {
+            if (finished || maxSize <= 0)
+                return 0;
+
+            const uInt capacity = static_cast<uInt> (qMin<qint64> (maxSize, std::numeric_limits<uInt>::max ()));
+
+            stream.next_out	 = reinterpret_cast<Bytef *> (data);
+            stream.avail_out = capacity;
+
+            const int ret = inflate (&stream, Z_NO_FLUSH);
+
+            if (ret == Z_STREAM_END)
+                finished = true;
+            else if (ret == Z_BUF_ERROR && stream.avail_in == 0)
+            {
+                qDebug () << "Truncated deflate stream in xlsx entry";
+
+                finished = true;
+            }
+            else if (ret != Z_OK)
+            {
+                setErrorString (QStringLiteral ("inflate failed"));
+
+                return -1;
+            }
+
+
+            return capacity - stream.avail_out;
+        }
+
+        qint64 writeData (const char *data, qint64 maxSize) override
+        {
+            Q_UNUSED (data);
+            Q_UNUSED (maxSize);
+
+
+            return -1;
+        }
+
+
+    private:
+        const char *compressed;
+        quint32 compressedSize;
+        bool finished = false;
+
+        z_stream stream{};
+        bool streamInitialized = false;
+    };
+} // namespace
+
+
+XlsxZipArchive::XlsxZipArchive (const QString &filePath) : file (filePath)
+{
+    if (mapFile ())
+        valid = readCentralDirectory ();
+}
+
+XlsxZipArchive::~XlsxZipArchive ()
+{
+    if (bytes && loadedData.isEmpty ())
+        file.unmap (reinterpret_cast<uchar *> (const_cast<char *> (bytes)));
+}
+
+
+bool XlsxZipArchive::mapFile ()
+{
+    if (! file.open (QIODevice::ReadOnly))
+    {
+        qDebug () << "Cannot open file for read:" << file.fileName ();
+
+        return false;
+    }
+
+    size = file.size ();
+    if (size <= 0)
+        return false;
+
+    // QByteArray views (rawData, stored entries) are int-sized; no price list comes close
+    if (size > std::numeric_limits<int>::max ())
+    {
+        qDebug () << "File too large for the xlsx reader (2 GB or more):" << file.fileName ();
+
+        return false;
+    }
+
+    if (uchar *mapped = file.map (0, size))
+    {
+        bytes = reinterpret_cast<const char *> (mapped);
+
+        return true;
+    }
+
+
+    // Some file systems (pipes, certain network shares) cannot be mapped - read the file once instead
+    loadedData = file.readAll ();
+
+    if (loadedData.size () != size)
+        return false;
+
+    bytes = loadedData.constData ();
+
+
+    return true;
+}
+
+QByteArray XlsxZipArchive::rawData () const { return bytes ? QByteArray::fromRawData (bytes, int (size)) : QByteArray (); }
+
+bool XlsxZipArchive::hasZipSignature () const { return bytes && size >= 4 && bytes[0] == 'P' && bytes[1] == 'K'; }
+
+
+bool XlsxZipArchive::readCentralDirectory ()
+{
+    if (size < endOfCentralDirSize)
+        return false;
+
+
+    // End of central directory record is the last 22 bytes plus an optional archive comment
+    const qint64 searchStart = qMax<qint64> (0, size - endOfCentralDirSize - maxCommentSize);
+    qint64 eocd				 = -1;
+
+    for (qint64 i = size - endOfCentralDirSize; i >= searchStart; --i)
+    {
+        if (readU32 (bytes + i) == endOfCentralDirSignature)
+        {
+            eocd = i;
+
+            break;
+        }
+    }
+
+    if (eocd < 0)
+    {
+        qDebug () << "ZIP end of central directory not found:" << file.fileName ();
+
+        return false;
+    }
+
+
+    const char *e			 = bytes + eocd;
+    const quint16 entryCount = readU16 (e + 10);
+    const quint32 cdSize	 = readU32 (e + 12);
+    const quint32 cdOffset	 = readU32 (e + 16);
+
+    // ZIP64 markers - not expected for price lists, the caller falls back to QXlsx
+    if (entryCount == 0xFFFF || cdOffset == 0xFFFFFFFF || qint64 (cdOffset) + cdSize > size)
+        return false;
+
+
+    const char *cd	= bytes + cdOffset;
+    qint64 pos		= 0;
+
+    for (int i = 0; i < entryCount; ++i)
+    {
+        if (pos + centralHeaderSize > cdSize)
+            return false;
+
+        const char *h = cd + pos;
+
+        if (readU32 (h) != centralHeaderSignature)
+            return false;
+
+        Entry entry;
+
+        entry.method			= readU16 (h + 10);
+        entry.compressedSize	= readU32 (h + 20);
+        entry.uncompressedSize	= readU32 (h + 24);
+        entry.localHeaderOffset = readU32 (h + 42);
+
+        const quint16 nameLen	 = readU16 (h + 28);
+        const quint16 extraLen	 = readU16 (h + 30);
+        const quint16 commentLen = readU16 (h + 32);
+
+        if (pos + centralHeaderSize + nameLen > cdSize)
+            return false;
+
+        const QString name = QString::fromUtf8 (h + centralHeaderSize, nameLen);
+
+        entries.insert (name, entry);
+        paths.append (name);
+
+        pos += centralHeaderSize + nameLen + extraLen + commentLen;
+    }
+
+
+    return true;
+}
+
+
+QIODevice *XlsxZipArchive::openEntry (const QString &path) const
+{
+    const auto it = entries.constFind (path);
+    if (it == entries.constEnd ())
+        return nullptr;
+
+    const Entry &entry = it.value ();
+
+    if (entry.method != methodStored && entry.method != methodDeflated)
+    {
+        qDebug () << "Unsupported ZIP compression method" << entry.method << "for" << path;
+
+        return nullptr;
+    }
+
+
+    // Local name/extra lengths may differ from the central directory copy, so take them from the local header
+    const qint64 headerOffset = entry.localHeaderOffset;
+
+    if (headerOffset + localHeaderSize > size || readU32 (bytes + headerOffset) != localHeaderSignature)
+        return nullptr;
+
+    const qint64 dataOffset = headerOffset + localHeaderSize + readU16 (bytes + headerOffset + 26) + readU16 (bytes + headerOffset + 28);
+
+    if (dataOffset + entry.compressedSize > size)
+        return nullptr;
+
+
+    QIODevice *device = nullptr;
+
+    if (entry.method == methodStored)
+    {
+        QBuffer *buffer = new QBuffer ();
+
+        buffer->setData (QByteArray::fromRawData (bytes + dataOffset, int (entry.compressedSize)));
+        device = buffer;
+    }
+    else
+        device = new InflateEntryDevice (bytes + dataOffset, entry.compressedSize);
+
+    if (! device->open (QIODevice::ReadOnly))
+    {
+        delete device;
+
+        return nullptr;
+    }
+
+
+    return device;
+}
+
+
+QByteArray XlsxZipArchive::fileData (const QString &path) const
+{
+    QIODevice *device = openEntry (path);
+    if (! device)
+        return {};
+
+    // Copy: stored entries are raw views into the mapping
+    QByteArray data = device->readAll ();
+    data.detach ();
+
+    delete device;
+
+
+    return data;
+}
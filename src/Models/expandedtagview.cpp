@@ -0,0 +1,31 @@
+#include "expandedtagview.h"
+
+#include <algorithm>
+
+
+ExpandedTagView::ExpandedTagView (const PriceTagTable &table) : source (table)
+{
+    const QVector<int> &quantities = table.quantities ();
+    qint64 total				   = 0;
+
+    rowEnds.reserve (quantities.size ());
+
+    for (int quantity : quantities)
+    {
+        total += qMax (1, quantity);
+        rowEnds.append (total);
+    }
+}
+
+
+ExpandedTagView::Slot ExpandedTagView::slot (qint64 index) const
+{
+    const auto it = std::upper_bound (rowEnds.cbegin (), rowEnds.cend (), index);
+
+    Slot result;
+    result.row	= int (it - rowEnds.cbegin ());
+    result.copy = int (index - firstIndex (result.row));
+
+
+    return result;
+}
@@ -0,0 +1,129 @@
+#include "money.h"
+
+#include <cmath>
+#include <limits>
+
+
+namespace
+{
+    // "00".."99": two digits per lookup instead of a division per digit
+    const char digitPairs[] = "00010203040506070809"
+                              "10111213141516171819"
+                              "20212223242526272829"
+                              "30313233343536373839"
+                              "40414243444546474849"
+                              "50515253545556575859"
+                              "60616263646566676869"
+                              "70717273747576777879"
+                              "80818283848586878889"
+                              "90919293949596979899";
+
+    const ushort groupSeparator = 0x00A0; // no-break space: the price never wraps inside the number
+
+
+    // Digits of value right-aligned at end; returns the first written position
+    QChar *writeDigits (QChar *end, quint64 value)
+    {
+        while (value >= 100)
+        {
+            const int pair = int (value % 100) * 2;
+
+            value /= 100;
+
+            *--end = QLatin1Char (digitPairs[pair + 1]);
+            *--end = QLatin1Char (digitPairs[pair]);
+        }
+
+        if (value >= 10)
+        {
+            const int pair = int (value) * 2;
+
+            *--end = QLatin1Char (digitPairs[pair + 1]);
+            *--end = QLatin1Char (digitPairs[pair]);
+        }
+        else
+            *--end = QLatin1Char (char ('0' + value));
+
+
+        return end;
+    }
+} // namespace
+
+
+Money Money::fromDouble (double value)
+{
+    const double scaled = std::round (value * 100.0);
+
+    if (! std::isfinite (scaled) || std::fabs (scaled) >= double (std::numeric_limits<qint64>::max ()))
+        return Money ();
+
+
+    return Money (qint64 (scaled));
+}
+
+
+int Money::format (QChar *out, bool thousandsGrouping) const
+{
+    const bool negative = units < 0;
+    const quint64 abs	= negative ? quint64 (0) - quint64 (units) : quint64 (units);
+    const quint64 whole = abs / 100;
+    const int cents		= int (abs % 100);
+
+    QChar buffer[maxFormattedLength];
+    QChar *const end = buffer + maxFormattedLength;
+    QChar *p		 = end;
+
+
+    if (cents != 0)
+    {
+        *--p = QLatin1Char (digitPairs[cents * 2 + 1]);
+        *--p = QLatin1Char (digitPairs[cents * 2]);
+        *--p = QLatin1Char (',');
+    }
+
+    if (! thousandsGrouping)
+        p = writeDigits (p, whole);
+    else
+    {
+        // Groups of three from the right, each padded to three digits except the leading one
+        quint64 rest = whole;
+
+        while (rest >= 1000)
+        {
+            const int group = int (rest % 1000);
+
+            rest /= 1000;
+
+            QChar *groupStart = writeDigits (p, quint64 (group));
+
+            while (p - groupStart < 3)
+                *--groupStart = QLatin1Char ('0');
+
+            p	 = groupStart;
+            *--p = QChar (groupSeparator);
+        }
+
+        p = writeDigits (p, rest);
+    }
+
+    if (negative)
+        *--p = QLatin1Char ('-');
+
+
+    const int length = int (end - p);
+
+    for (int i = 0; i < length; ++i)
+        out[i] = p[i];
+
+
+    return length;
+}
+
+QString Money::toString (bool thousandsGrouping) const
+{
+    QChar buffer[maxFormattedLength];
+    const int length = format (buffer, thousandsGrouping);
+
+
+    return QString (buffer, length);
+}
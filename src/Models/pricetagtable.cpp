@@ -0,0 +1,347 @@
+#include "pricetagtable.h"
+
+#include <utility>
+
+
+namespace
+{
+    const quint64 fnvOffset = 14695981039346656037ULL;
+    const quint64 fnvPrime	= 1099511628211ULL;
+
+
+    void hashBytes (quint64 &hash, const void *data, size_t size)
+    {
+        const uchar *p = static_cast<const uchar *> (data);
+
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ p[i]) * fnvPrime;
+    }
+
+    // Length first, so that moving text between adjacent fields changes the hash
+    void hashText (quint64 &hash, const QString &text)
+    {
+        const int length = text.size ();
+
+        hashBytes (hash, &length, sizeof (length));
+        hashBytes (hash, text.constData (), size_t (length) * sizeof (QChar));
+    }
+} // namespace
+
+
+PriceTagTable::PriceTagTable () { strings.append (QString ()); }
+
+
+PriceTagTable PriceTagTable::fromList (const QList<PriceTag> &priceTags)
+{
+    PriceTagTable table;
+
+    table.reserve (priceTags.size ());
+
+    for (const PriceTag &priceTag : priceTags)
+        table.append (priceTag);
+
+
+    return table;
+}
+
+QList<PriceTag> PriceTagTable::toList () const
+{
+    QList<PriceTag> priceTags;
+
+    priceTags.reserve (size ());
+
+    for (int row = 0; row < size (); ++row)
+        priceTags.append (at (row));
+
+
+    return priceTags;
+}
+
+
+void PriceTagTable::reserve (int rows)
+{
+    for (QVector<quint32> &column : textColumns)
+        column.reserve (rows);
+
+    priceColumn.reserve (rows);
+    price2Column.reserve (rows);
+    quantityColumn.reserve (rows);
+    hashColumn.reserve (rows);
+}
+
+void PriceTagTable::clear ()
+{
+    for (QVector<quint32> &column : textColumns)
+        column.clear ();
+
+    priceColumn.clear ();
+    price2Column.clear ();
+    quantityColumn.clear ();
+    hashColumn.clear ();
+
+    strings.clear ();
+    stringIds.clear ();
+
+    strings.append (QString ());
+}
+
+
+quint32 PriceTagTable::internString (const QString &value)
+{
+    if (value.isEmpty ())
+        return 0;
+
+    const auto it = stringIds.constFind (value);
+    if (it != stringIds.constEnd ())
+        return it.value ();
+
+    const quint32 id = quint32 (strings.size ());
+
+    strings.append (value);
+    stringIds.insert (value, id);
+
+
+    return id;
+}
+
+
+void PriceTagTable::append (const PriceTag &priceTag)
+{
+    textColumns[Name].append (internString (priceTag.getName ()));
+    textColumns[Description].append (internString (priceTag.getDescription ()));
+    textColumns[Supplier].append (internString (priceTag.getSupplier ()));
+    textColumns[Address].append (internString (priceTag.getAddress ()));
+    textColumns[Brand].append (internString (priceTag.getBrand ()));
+    textColumns[Category].append (internString (priceTag.getCategory ()));
+    textColumns[AdditionalData].append (internString (priceTag.getAdditionalData ()));
+    textColumns[Gender].append (internString (priceTag.getGender ()));
+    textColumns[BrandCountry].append (internString (priceTag.getBrandCountry ()));
+    textColumns[ManufacturingPlace].append (internString (priceTag.getManufacturingPlace ()));
+    textColumns[Material].append (internString (priceTag.getMaterial ()));
+    textColumns[Size].append (internString (priceTag.getSize ()));
+    textColumns[Article].append (internString (priceTag.getArticle ()));
+    textColumns[AdditionalData2].append (internString (priceTag.getAdditionalData2 ()));
+
+    priceColumn.append (priceTag.getPriceMoney ());
+    price2Column.append (priceTag.getPrice2Money ());
+    quantityColumn.append (priceTag.getQuantity ());
+    hashColumn.append (contentHash (priceTag));
+}
+
+void PriceTagTable::appendRow (const PriceTagTable &source, int row)
+{
+    for (int column = 0; column < TextColumnCount; ++column)
+        textColumns[column].append (source.textColumns[column].at (row));
+
+    priceColumn.append (source.priceColumn.at (row));
+    price2Column.append (source.price2Column.at (row));
+    quantityColumn.append (source.quantityColumn.at (row));
+    hashColumn.append (source.hashColumn.at (row));
+}
+
+PriceTag PriceTagTable::at (int row) const
+{
+    PriceTag priceTag (text (Name, row), text (Description, row), 0.0, quantityColumn.at (row));
+
+    priceTag.setPrice (priceColumn.at (row));
+    priceTag.setSupplier (text (Supplier, row));
+    priceTag.setAddress (text (Address, row));
+    priceTag.setBrand (text (Brand, row));
+    priceTag.setCategory (text (Category, row));
+    priceTag.setAdditionalData (text (AdditionalData, row));
+    priceTag.setGender (text (Gender, row));
+    priceTag.setBrandCountry (text (BrandCountry, row));
+    priceTag.setManufacturingPlace (text (ManufacturingPlace, row));
+    priceTag.setMaterial (text (Material, row));
+    priceTag.setSize (text (Size, row));
+    priceTag.setArticle (text (Article, row));
+    priceTag.setPrice2 (price2Column.at (row));
+    priceTag.setAdditionalData2 (text (AdditionalData2, row));
+
+
+    return priceTag;
+}
+
+
+quint64 PriceTagTable::contentHash (const PriceTag &priceTag)
+{
+    quint64 hash = fnvOffset;
+
+    // Supplier and address are the forward-filled values, so a row whose context changed hashes differently
+    hashText (hash, priceTag.getName ());
+    hashText (hash, priceTag.getDescription ());
+    hashText (hash, priceTag.getSupplier ());
+    hashText (hash, priceTag.getAddress ());
+    hashText (hash, priceTag.getBrand ());
+    hashText (hash, priceTag.getCategory ());
+    hashText (hash, priceTag.getAdditionalData ());
+    hashText (hash, priceTag.getGender ());
+    hashText (hash, priceTag.getBrandCountry ());
+    hashText (hash, priceTag.getManufacturingPlace ());
+    hashText (hash, priceTag.getMaterial ());
+    hashText (hash, priceTag.getSize ());
+    hashText (hash, priceTag.getArticle ());
+    hashText (hash, priceTag.getAdditionalData2 ());
+
+    const qint64 price	= priceTag.getPriceMoney ().minorUnits ();
+    const qint64 price2 = priceTag.getPrice2Money ().minorUnits ();
+    const int quantity	= priceTag.getQuantity ();
+
+    hashBytes (hash, &price, sizeof (price));
+    hashBytes (hash, &price2, sizeof (price2));
+    hashBytes (hash, &quantity, sizeof (quantity));
+
+
+    return hash;
+}
+
+
+bool PriceTagTable::sameContent (int row, int other) const
+{
+    for (const QVector<quint32> &column : textColumns)
+    {
+        if (column.at (row) != column.at (other))
+            return false;
+    }
+
+
+    return priceColumn.at (row) == priceColumn.at (other) && price2Column.at (row) == price2Column.at (other) &&
+           quantityColumn.at (row) == quantityColumn.at (other);
+}
+
+
+PriceTagDelta PriceTagTable::diff (const QList<PriceTag> &updated) const
+{
+    PriceTagDelta delta;
+
+    // First unused old row per hash, chained through nextSameHash so duplicate rows match in order
+    QHash<quint64, int> firstUnused;
+    QVector<int> nextSameHash (size (), -1);
+
+    firstUnused.reserve (size ());
+
+    for (int row = size () - 1; row >= 0; --row)
+    {
+        const auto it = firstUnused.find (hashColumn.at (row));
+
+        if (it != firstUnused.end ())
+        {
+            nextSameHash[row] = it.value ();
+            it.value ()		  = row;
+        }
+        else
+            firstUnused.insert (hashColumn.at (row), row);
+    }
+
+
+    QVector<bool> kept (size (), false);
+    int previousKept = -1;
+
+    delta.sourceRows.reserve (updated.size ());
+
+    for (const PriceTag &priceTag : updated)
+    {
+        const auto it = firstUnused.find (contentHash (priceTag));
+
+        if (it == firstUnused.end () || it.value () < 0)
+        {
+            delta.sourceRows.append (-1);
+            delta.addedTags.append (priceTag);
+
+            continue;
+        }
+
+        const int row = it.value ();
+
+        it.value () = nextSameHash.at (row);
+        kept[row]	= true;
+
+        if (row < previousKept)
+            delta.reordered = true;
+
+        previousKept = row;
+        delta.sourceRows.append (row);
+    }
+
+    for (int row = 0; row < size (); ++row)
+    {
+        if (! kept.at (row))
+            delta.removedRows.append (row);
+    }
+
+
+    return delta;
+}
+
+void PriceTagTable::applyDelta (const PriceTagDelta &delta)
+{
+    if (delta.isEmpty ())
+        return;
+
+    // Kept rows are copied as ids and numbers; only added tags go through the arena.
+    // Strings of removed and edited rows stay behind until compactStrings () finds too many of them.
+    PriceTagTable updated;
+
+    updated.strings	  = strings;
+    updated.stringIds = stringIds;
+    updated.reserve (delta.sourceRows.size ());
+
+    int nextAdded = 0;
+
+    for (int source : delta.sourceRows)
+    {
+        if (source >= 0)
+            updated.appendRow (*this, source);
+        else
+            updated.append (delta.addedTags.at (nextAdded++));
+    }
+
+    updated.compactStrings ();
+
+    *this = std::move (updated);
+}
+
+void PriceTagTable::compactStrings ()
+{
+    // New id per old id, in first-use order; 0 marks a string no row refers to
+    QVector<quint32> remap (strings.size (), 0);
+    int live = 1;
+
+    for (const QVector<quint32> &column : textColumns)
+    {
+        for (quint32 id : column)
+        {
+            if (id != 0 && remap.at (int (id)) == 0)
+                remap[int (id)] = quint32 (live++);
+        }
+    }
+
+    // Rebuilding costs a pass over every column: only worth it once the dead strings outnumber the live ones
+    if (strings.size () - live <= live)
+        return;
+
+
+    QVector<QString> compacted (live);
+
+    stringIds.clear ();
+    stringIds.reserve (live);
+
+    for (int id = 1; id < strings.size (); ++id)
+    {
+        const quint32 newId = remap.at (id);
+
+        if (newId == 0)
+            continue;
+
+        compacted[int (newId)] = strings.at (id);
+        stringIds.insert (compacted.at (int (newId)), newId);
+    }
+
+    for (QVector<quint32> &column : textColumns)
+    {
+        for (quint32 &id : column)
+            id = remap.at (int (id));
+    }
+
+    strings = std::move (compacted);
+}
@@ -0,0 +1,17 @@
+#include "stringpool.h"
+
+
+QString StringPool::intern (const QString &value)
+{
+    if (value.isEmpty ())
+        return QString ();
+
+    const auto it = pool.constFind (value);
+    if (it != pool.constEnd ())
+        return *it;
+
+    pool.insert (value);
+
+
+    return value;
+}
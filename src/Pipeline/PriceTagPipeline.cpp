@@ -0,0 +1,133 @@
+#include "PriceTagPipeline.h"
+
+#include <QDebug>
+#include <QFuture>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "BoundedQueue.h"
+#include "ExcelParser.h"
+#include "WordGenerator.h"
+#include "pricetag.h"
+
+
+namespace
+{
+    // Batches keep queue locking off the per-row path; 16 x 256 tags stay far below a 64 MB budget
+    const int batchSize		= 256;
+    const int queueCapacity = 16;
+} // namespace
+
+
+PriceTagPipeline::PriceTagPipeline (WordGenerator &generator, bool parseAllSheets, QObject *parent)
+    : QObject (parent), generator (generator), allSheets (parseAllSheets)
+{
+}
+
+
+void PriceTagPipeline::cancel () { cancelRequested = true; }
+
+bool PriceTagPipeline::isCancelled () const { return cancelRequested; }
+
+
+bool PriceTagPipeline::run (const QString &inputPath, const QString &outputPath)
+{
+    tagsWritten = 0;
+
+    if (cancelRequested || ! generator.beginStream (outputPath))
+        return false;
+
+    BoundedQueue<QVector<PriceTag>> queue (queueCapacity);
+
+    ExcelParser parser;
+    parser.setParseAllSheets (allSheets);
+
+    // The parser reports from the producer thread; the signal is queued to whoever owns the pipeline
+    connect (&parser, &ExcelParser::progressChanged, this, &PriceTagPipeline::progressChanged);
+
+
+    auto produce = [this, &parser, &queue, inputPath] ()
+    {
+        QVector<PriceTag> batch;
+        batch.reserve (batchSize);
+
+        auto sink = [this, &queue, &batch] (const PriceTag &tag)
+        {
+            if (cancelRequested)
+                return false;
+
+            batch.append (tag);
+
+            if (batch.size () < batchSize)
+                return true;
+
+            const bool accepted = queue.push (std::move (batch));
+
+            batch.clear ();
+            batch.reserve (batchSize);
+
+
+            return accepted;
+        };
+
+        const bool parsed = parser.parseFileStreaming (inputPath, sink);
+
+        if (parsed && ! batch.isEmpty ())
+            queue.push (std::move (batch));
+
+        queue.close ();
+
+
+        return parsed;
+    };
+
+    QFuture<bool> producer = QtConcurrent::run (produce);
+
+
+    bool written = true;
+    QVector<PriceTag> batch;
+
+    while (written && ! cancelRequested && queue.pop (batch))
+    {
+        for (const PriceTag &tag : batch)
+        {
+            if (! generator.streamTag (tag))
+            {
+                written = false;
+
+                break;
+            }
+
+            ++tagsWritten;
+        }
+    }
+
+    // Unblocks a producer waiting on a full queue after a write error or a cancel
+    if (! written || cancelRequested)
+        queue.abort ();
+
+    const bool parsed = producer.result ();
+
+    if (cancelRequested)
+    {
+        qDebug () << "Streaming pipeline cancelled:" << inputPath;
+
+        generator.cancelStream ();
+
+        return false;
+    }
+
+    if (! parsed || ! written)
+    {
+        qDebug () << "Streaming pipeline failed:" << (parsed ? "write error" : "parse error") << inputPath;
+
+        generator.cancelStream ();
+
+        return false;
+    }
+
+    qDebug () << "Streaming pipeline wrote" << tagsWritten << "price tags to" << outputPath;
+
+
+    return generator.finishStream ();
+}
@@ -6,6 +6,7 @@
 #include <QFontComboBox>
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QSignalBlocker>
 #include <QSpinBox>
 
 
@@ -13,9 +14,9 @@ TemplateEditorWidget::TemplateEditorWidget (QWidget *parent) :
     QWidget (parent), view (new QGraphicsView (this)), scene (new QGraphicsScene (this)), spinTagW (new QDoubleSpinBox (this)),
     spinTagH (new QDoubleSpinBox (this)), spinMarginL (new QDoubleSpinBox (this)), spinMarginT (new QDoubleSpinBox (this)),
     spinMarginR (new QDoubleSpinBox (this)), spinMarginB (new QDoubleSpinBox (this)), spinSpacingH (new QDoubleSpinBox (this)),
-    spinSpacingV (new QDoubleSpinBox (this)), comboField (new QComboBox (this)), fontFamilyBox (new QFontComboBox (this)),
-    fontSizeSpin (new QSpinBox (this)), boldCheck (new QCheckBox (tr ("Bold"), this)), italicCheck (new QCheckBox (tr ("Italic"), this)),
-    strikeCheck (new QCheckBox (tr ("Strike"), this)), alignBox (new QComboBox (this))
+    spinSpacingV (new QDoubleSpinBox (this)), priceGroupingCheck (new QCheckBox (this)), comboField (new QComboBox (this)),
+    fontFamilyBox (new QFontComboBox (this)), fontSizeSpin (new QSpinBox (this)), boldCheck (new QCheckBox (tr ("Bold"), this)),
+    italicCheck (new QCheckBox (tr ("Italic"), this)), strikeCheck (new QCheckBox (tr ("Strike"), this)), alignBox (new QComboBox (this))
 {
     initializeUi ();
     rebuildScene ();
@@ -33,6 +34,8 @@ void TemplateEditorWidget::onParametersChanged ()
     templateModel.spacingHMm	 = spinSpacingH->value ();
     templateModel.spacingVMm	 = spinSpacingV->value ();
 
+    templateModel.priceThousandsGrouping = priceGroupingCheck->isChecked ();
+
     rebuildScene ();
 
     emit templateChanged (templateModel);
@@ -63,6 +66,13 @@ void TemplateEditorWidget::setTagTemplate (const TagTemplate &tpl)
 {
     templateModel = tpl;
 
+    {
+        // Before the spin boxes: their change handlers read the checkbox back into the model
+        const QSignalBlocker blocker (priceGroupingCheck);
+
+        priceGroupingCheck->setChecked (tpl.priceThousandsGrouping);
+    }
+
     setTagSizeMm (tpl.tagWidthMm, tpl.tagHeightMm);
     setMarginsMm (tpl.marginLeftMm, tpl.marginTopMm, tpl.marginRightMm, tpl.marginBottomMm);
     setSpacingMm (tpl.spacingHMm, tpl.spacingVMm);
@@ -51,6 +51,7 @@ void TemplateEditorWidget::updateGeometryFormLabels (const QString &lang)
     setLabelForField (geomForm, spinMarginB, lang, "Margin bottom (mm)", "Отступ снизу (мм)");
     setLabelForField (geomForm, spinSpacingH, lang, "Spacing horizontal (mm)", "Горизонтальный зазор (мм)");
     setLabelForField (geomForm, spinSpacingV, lang, "Spacing vertical (mm)", "Вертикальный зазор (мм)");
+    setLabelForField (geomForm, priceGroupingCheck, lang, "Group price thousands", "Разделять разряды цены");
 }
 
 void TemplateEditorWidget::updateTypographyFormLabels (const QString &lang)
@@ -143,6 +143,7 @@ void TemplateEditorWidget::createFormsAndGroups (QWidget *rightPanel, QVBoxLayou
     geomForm->addRow (tr ("Margin bottom (mm)"), spinMarginB);
     geomForm->addRow (tr ("Spacing horizontal (mm)"), spinSpacingH);
     geomForm->addRow (tr ("Spacing vertical (mm)"), spinSpacingV);
+    geomForm->addRow (tr ("Group price thousands"), priceGroupingCheck);
 
     rightLayout->addWidget (geomBox);
 }
@@ -218,6 +219,8 @@ void TemplateEditorWidget::connectDimensionSpinBoxes ()
 
     for (QDoubleSpinBox *s : {spinTagW, spinTagH, spinMarginL, spinMarginT, spinMarginR, spinMarginB, spinSpacingH, spinSpacingV})
         connect (s, QOverload<double>::of (&QDoubleSpinBox::valueChanged), this, onChange);
+
+    connect (priceGroupingCheck, &QCheckBox::toggled, this, onChange);
 }
 
 void TemplateEditorWidget::connectFieldSelection ()
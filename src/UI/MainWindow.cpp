@@ -2,6 +2,7 @@
 
 #include <QAction>
 #include <QApplication>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDebug>
 #include <QDragEnterEvent>
@@ -11,6 +12,8 @@
 #include <QEvent>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
 #include <QHBoxLayout>
 #include <QIcon>
 #include <QLabel>
@@ -22,11 +25,15 @@
 #include <QPushButton>
 #include <QTabWidget>
 #include <QTextEdit>
+#include <QThreadPool>
+#include <QTimer>
 #include <QToolBar>
 #include <QToolButton>
 #include <QUrl>
 #include <QVBoxLayout>
+#include <QVector>
 #include <QWidget>
+#include <QtConcurrent/QtConcurrentRun>
 
 #ifdef USE_QT_CHARTS
 #include <QtCharts/QBarCategoryAxis>
@@ -45,24 +52,93 @@ using namespace QtCharts;
 
 #include "ExcelGenerator.h"
 #include "ExcelParser.h"
+#include "PriceTagPipeline.h"
 #include "WordGenerator.h"
 #include "configmanager.h"
 #include "pixmaputils.h"
 #include "pricetag.h"
+#include "pricetagtable.h"
 #include "templateeditor.h"
 #include "templateeditordialog.h"
 #include "thememanager.h"
 #include "trimmedhittoolbutton.h"
 
 
+namespace
+{
+    // Excel saves through a temporary file and a rename; wait for the writes to settle before re-parsing
+    const int reloadDebounceMs = 500;
+
+
+    void adjustCount (QMap<QString, int> &counts, const QString &value, int delta)
+    {
+        if (value.isEmpty ())
+            return;
+
+        int &count = counts[value];
+
+        count += delta;
+
+        if (count <= 0)
+            counts.remove (value);
+    }
+
+    // Statistics totals are kept in kopecks and shown in whole rubles
+    QString formatRubles (qint64 kopecks) { return QString::number (double (kopecks) / 100.0, 'f', 0); }
+
+    // Adds (sign = 1) or takes back (sign = -1) one row's share of the statistics
+    void accumulateTag (StatisticsData &data, const PriceTag &tag, int sign)
+    {
+        const int q			= tag.getQuantity () * sign;
+        const qint64 price	= tag.getPriceMoney ().minorUnits ();
+        const qint64 price2 = tag.getPrice2Money ().minorUnits ();
+
+        data.totalProducts += sign;
+        data.totalTags += q;
+
+        if (tag.hasDiscount ())
+        {
+            data.productsWithDiscount += sign;
+            data.totalDiscountValue += (price - price2) * q;
+        }
+
+        data.totalValue += (price2 > 0 ? price2 : price) * q;
+
+        adjustCount (data.brandCount, tag.getBrand (), sign);
+        adjustCount (data.categoryCount, tag.getCategory (), sign);
+        adjustCount (data.supplierCount, tag.getSupplier (), sign);
+    }
+
+
+    // Occurrences of each non-empty value of one text column; ids are dense, so counting is a plain array walk
+    void countTextColumn (const PriceTagTable &table, PriceTagTable::TextColumn column, QMap<QString, int> &counts)
+    {
+        QVector<int> perId (table.stringCount (), 0);
+
+        for (quint32 id : table.textColumn (column))
+            ++perId[int (id)];
+
+        for (int id = 1; id < perId.size (); ++id)
+        {
+            if (perId.at (id) > 0)
+                counts[table.string (quint32 (id))] += perId.at (id);
+        }
+    }
+} // namespace
+
+
 MainWindow::MainWindow (QWidget *parent) : QMainWindow (parent)
 {
     excelParser	   = new ExcelParser (this);
     wordGenerator  = new WordGenerator (this);
     excelGenerator = new ExcelGenerator (this);
 
+    pipelineWatcher = new QFutureWatcher<bool> (this);
+    connect (pipelineWatcher, &QFutureWatcher<bool>::finished, this, &MainWindow::onStreamingFinished);
+
     setupUI ();
     setupToolbar ();
+    setupFileWatcher ();
 
     // Load template configuration (or save defaults if missing)
     {
@@ -80,7 +156,15 @@ MainWindow::MainWindow (QWidget *parent) : QMainWindow (parent)
     updateThemeStyles ();
 }
 
-MainWindow::~MainWindow () {}
+MainWindow::~MainWindow ()
+{
+    // The worker writes through wordGenerator, which is destroyed with the window
+    if (pipeline)
+    {
+        pipeline->cancel ();
+        pipelineWatcher->waitForFinished ();
+    }
+}
 
 
 bool MainWindow::eventFilter (QObject *obj, QEvent *event)
@@ -291,13 +375,68 @@ void MainWindow::setupMainTab ()
     outputFormatComboBox = new QComboBox (this);
     outputFormatComboBox->addItem (tr ("XLSX")); // 0 = XLSX
     outputFormatComboBox->addItem (tr ("DOCX")); // 1 = DOCX
+    outputFormatComboBox->addItem (tr ("DOCX (streaming)")); // 2 = DOCX written while parsing, nothing kept in memory
     outputFormatComboBox->setCurrentIndex (0);	 // Default to XLSX
     mainTabLayout->addWidget (outputFormatComboBox);
 
+    // DOCX package compression, in ZipCompression order: store/fast for quick local printing, max for archival exports
+    compressionComboBox = new QComboBox (this);
+    compressionComboBox->addItem (tr ("Compression: store"));
+    compressionComboBox->addItem (tr ("Compression: fast"));
+    compressionComboBox->addItem (tr ("Compression: normal"));
+    compressionComboBox->addItem (tr ("Compression: max"));
+    compressionComboBox->setCurrentIndex (qBound (0, settings.value ("output/compression", int (ZipCompression::Normal)).toInt (), 3));
+    compressionComboBox->setEnabled (! isExcelOutput ());
+    wordGenerator->setCompression (static_cast<ZipCompression> (compressionComboBox->currentIndex ()));
+    mainTabLayout->addWidget (compressionComboBox);
+
+    // Large DOCX runs open and print faster as one small table per page than as one table over every page
+    tablePerPageCheckBox = new QCheckBox (tr ("One table per page"), this);
+    tablePerPageCheckBox->setChecked (settings.value ("output/tablePerPage", false).toBool ());
+    tablePerPageCheckBox->setEnabled (! isExcelOutput ());
+    setTablePerPage (tablePerPageCheckBox->isChecked ());
+    mainTabLayout->addWidget (tablePerPageCheckBox);
+
+    // Workbooks with one sheet per store/category: parse every worksheet instead of the active one
+    allSheetsCheckBox = new QCheckBox (tr ("Parse all sheets"), this);
+    allSheetsCheckBox->setChecked (settings.value ("parser/allSheets", false).toBool ());
+    excelParser->setParseAllSheets (allSheetsCheckBox->isChecked ());
+    mainTabLayout->addWidget (allSheetsCheckBox);
+
     mainTabLayout->addWidget (progressBar);
 
     connect (openButton, &QPushButton::clicked, this, &MainWindow::openFile);
     connect (generateButton, &QPushButton::clicked, this, &MainWindow::generateDocument);
+    connect (excelParser, &ExcelParser::progressChanged, this, &MainWindow::onParsingProgress);
+    connect (excelParser, &ExcelParser::parsingFinished, this, &MainWindow::onParsingFinished);
+    connect (outputFormatComboBox, QOverload<int>::of (&QComboBox::currentIndexChanged), this,
+             [this] (int)
+             {
+                 compressionComboBox->setEnabled (! isExcelOutput ());
+                 tablePerPageCheckBox->setEnabled (! isExcelOutput ());
+
+                 // A file picked for streaming was never loaded; the in-memory formats need it parsed
+                 if (! isStreamingOutput () && priceTable.isEmpty () && ! currentFilePath.isEmpty ())
+                     processFile (currentFilePath);
+             });
+    connect (compressionComboBox, QOverload<int>::of (&QComboBox::currentIndexChanged), this,
+             [this] (int index)
+             {
+                 settings.setValue ("output/compression", index);
+                 wordGenerator->setCompression (static_cast<ZipCompression> (index));
+             });
+    connect (tablePerPageCheckBox, &QCheckBox::toggled, this,
+             [this] (bool checked)
+             {
+                 settings.setValue ("output/tablePerPage", checked);
+                 setTablePerPage (checked);
+             });
+    connect (allSheetsCheckBox, &QCheckBox::toggled, this,
+             [this] (bool checked)
+             {
+                 settings.setValue ("parser/allSheets", checked);
+                 excelParser->setParseAllSheets (checked);
+             });
 
     tabWidget->addTab (mainTab, tr ("Main"));
 }
@@ -427,7 +566,7 @@ void MainWindow::dragLeaveEvent (QDragLeaveEvent *event)
 }
 
 
-QString MainWindow::buildStatisticsText () const { return formatStatisticsText (aggregateStatistics ()); }
+QString MainWindow::buildStatisticsText () const { return formatStatisticsText (statistics); }
 
 QString MainWindow::buildPrimaryButtonStyle (bool isDark) const
 {
@@ -574,11 +713,31 @@ void MainWindow::updateLanguageTexts ()
         langButton->setText (uiLanguage);
 
     if (openButton)
-        openButton->setText (localized ("Open Excel File", "Открыть файл Excel"));
+    {
+        if (pipeline)
+            openButton->setText (localized ("Cancel Generation", "Отменить генерацию"));
+        else
+            openButton->setText (excelParser && excelParser->isParsing () ? localized ("Cancel Loading", "Отменить загрузку")
+                                                                          : localized ("Open Excel File", "Открыть файл Excel"));
+    }
 
     if (generateButton)
         generateButton->setText (localized ("  Generate Price Tags", "  Сгенерировать ценники"));
 
+    if (allSheetsCheckBox)
+        allSheetsCheckBox->setText (localized ("Parse all sheets", "Все листы книги"));
+
+    if (tablePerPageCheckBox)
+        tablePerPageCheckBox->setText (localized ("One table per page", "Отдельная таблица на странице"));
+
+    if (compressionComboBox)
+    {
+        compressionComboBox->setItemText (0, localized ("Compression: store", "Сжатие: без сжатия"));
+        compressionComboBox->setItemText (1, localized ("Compression: fast", "Сжатие: быстрое"));
+        compressionComboBox->setItemText (2, localized ("Compression: normal", "Сжатие: обычное"));
+        compressionComboBox->setItemText (3, localized ("Compression: max", "Сжатие: максимальное"));
+    }
+
     if (refreshStatsButton)
         refreshStatsButton->setText (localized ("Refresh Statistics", "Обновить статистику"));
 
@@ -684,6 +843,10 @@ void MainWindow::styleLanguageButton (bool isDark)
 
 void MainWindow::applyTemplateToGenerators (const TagTemplate &tpl)
 {
+    // A running generation reads the layout from its worker; the edit is applied once it finishes
+    if (pipeline)
+        return;
+
     // Layout to generators from template geometry
     WordGenerator::DocxLayoutConfig wcfg = wordGenerator->layout ();
 
@@ -700,6 +863,15 @@ void MainWindow::applyTemplateToGenerators (const TagTemplate &tpl)
 }
 
 
+void MainWindow::setTablePerPage (bool enabled)
+{
+    WordGenerator::DocxLayoutConfig wcfg = wordGenerator->layout ();
+
+    wcfg.tablePerPage = enabled;
+    wordGenerator->setLayoutConfig (wcfg);
+}
+
+
 void MainWindow::toggleLanguage ()
 {
     uiLanguage = (uiLanguage == "EN") ? "RU" : "EN";
@@ -738,9 +910,16 @@ QIcon MainWindow::createGearIcon () const
 }
 
 
+bool MainWindow::isStreamingOutput () const { return outputFormatComboBox && outputFormatComboBox->currentIndex () == 2; }
+
+bool MainWindow::isExcelOutput () const { return outputFormatComboBox && outputFormatComboBox->currentIndex () == 0; }
+
+
 void MainWindow::generateDocument ()
 {
-    if (priceTags.isEmpty ())
+    const bool streaming = isStreamingOutput ();
+
+    if (streaming ? currentFilePath.isEmpty () : priceTable.isEmpty ())
     {
         QMessageBox::warning (this, localized ("No Data", "Нет данных"),
                               localized ("Please load an Excel file first.", "Пожалуйста, сначала загрузите файл Excel."));
@@ -748,7 +927,7 @@ void MainWindow::generateDocument ()
         return;
     }
 
-    const bool toExcel	 = (outputFormatComboBox && outputFormatComboBox->currentIndex () == 0);
+    const bool toExcel	 = isExcelOutput ();
     const QString filter = toExcel ? localized ("XLSX (*.xlsx)", "XLSX (*.xlsx)") : localized ("DOCX (*.docx)", "DOCX (*.docx)");
     QString suggested	 = toExcel ? localized ("out.xlsx", "out.xlsx") : localized ("out.docx", "out.docx");
     const QString outPath = QFileDialog::getSaveFileName (this, localized ("Save Output", "Сохранить вывод"), suggested, filter);
@@ -757,14 +936,66 @@ void MainWindow::generateDocument ()
         return;
 
 
-    bool ok = false;
+    if (streaming)
+    {
+        startStreamingGeneration (outPath);
 
-    if (toExcel)
-        ok = excelGenerator->generateExcelDocument (priceTags, outPath);
-    else
-        ok = wordGenerator->generateWordDocument (priceTags, outPath);
+        return;
+    }
 
 
+    const bool ok = toExcel ? excelGenerator->generateExcelDocument (priceTable, outPath)
+                            : wordGenerator->generateWordDocument (priceTable, outPath);
+
+    showGenerationResult (ok, outPath);
+}
+
+
+void MainWindow::startStreamingGeneration (const QString &outPath)
+{
+    pipeline		   = new PriceTagPipeline (*wordGenerator, allSheetsCheckBox && allSheetsCheckBox->isChecked (), this);
+    pipelineOutputPath = outPath;
+
+    connect (pipeline, &PriceTagPipeline::progressChanged, this, &MainWindow::onParsingProgress);
+    setGeneratingUiState (true);
+
+
+    PriceTagPipeline *job	  = pipeline;
+    const QString inputPath = currentFilePath;
+
+    pipelineWatcher->setFuture (QtConcurrent::run (
+        [job, inputPath, outPath] ()
+        {
+            // run () blocks on a parser task of its own: lend the pool a thread so that task cannot starve
+            QThreadPool::globalInstance ()->releaseThread ();
+            const bool ok = job->run (inputPath, outPath);
+            QThreadPool::globalInstance ()->reserveThread ();
+
+
+            return ok;
+        }));
+}
+
+
+void MainWindow::onStreamingFinished ()
+{
+    const bool ok		 = pipelineWatcher->result ();
+    const bool cancelled = pipeline->isCancelled ();
+
+    pipeline->deleteLater ();
+    pipeline = nullptr;
+
+    // Template edits made during the run were held back
+    applyTemplateToGenerators (currentTemplate);
+    setGeneratingUiState (false);
+
+    if (! cancelled)
+        showGenerationResult (ok, pipelineOutputPath);
+}
+
+
+void MainWindow::showGenerationResult (bool ok, const QString &outPath)
+{
     if (ok)
         QMessageBox::information (this, localized ("Success", "Успех"), localized ("Saved to: %1", "Сохранено в: %1").arg (outPath));
     else
@@ -775,21 +1006,94 @@ void MainWindow::generateDocument ()
 
 void MainWindow::processFile (const QString &filePath)
 {
-    if (filePath.isEmpty ())
+    if (filePath.isEmpty () || excelParser->isParsing () || pipeline)
+        return;
+
+    if (isStreamingOutput ())
+    {
+        // Nothing is loaded up front: the list is parsed while the document is written
+        currentFilePath = filePath;
+        priceTable.clear ();
+        statistics = StatisticsData ();
+
+        if (generateButton)
+            generateButton->setEnabled (true);
+
+        updateButtonsPrimaryStyles ();
+
+        if (dropArea)
+        {
+            setDropAreaSuccessStyle ();
+
+            const QFileInfo fi (filePath);
+
+            dropArea->setText (localized ("Selected for streaming: %1", "Выбрано для потоковой обработки: %1").arg (fi.fileName ()));
+        }
+
+        showStatistics ();
+
+        return;
+    }
+
+    if (! excelParser->parseAsync (filePath))
+        return;
+
+    reloadInProgress = false;
+
+    setParsingUiState (true);
+}
+
+
+void MainWindow::onParsingProgress (qint64 rowsProcessed, qint64 estimatedRows)
+{
+    if (! progressBar)
+        return;
+
+    // Sheets without a <dimension> give no estimate - show a busy indicator instead
+    if (estimatedRows <= 0)
+    {
+        progressBar->setRange (0, 0);
+
         return;
+    }
+
+    progressBar->setRange (0, 100);
+    progressBar->setValue (int (qMin<qint64> (100, rowsProcessed * 100 / estimatedRows)));
+}
 
 
-    QList<PriceTag> parsed;
-    if (! excelParser->parseExcelFile (filePath, parsed))
+void MainWindow::onParsingFinished (const QString &filePath, bool success, const QList<PriceTag> &parsed)
+{
+    setParsingUiState (false);
+
+    const bool isReload = reloadInProgress && filePath == currentFilePath;
+    reloadInProgress	= false;
+
+    if (isReload)
     {
-        QMessageBox::critical (this, localized ("Error", "Ошибка"),
-                               localized ("Failed to parse Excel file.", "Не удалось разобрать файл Excel."));
+        // A half-written or locked file keeps the previous data; the next save triggers another reload
+        if (success)
+            applyPriceListDelta (parsed);
+        else
+            qDebug () << "Reload failed, keeping the loaded price list:" << filePath;
+
+        return;
+    }
+
+    if (! success)
+    {
+        if (! excelParser->isCancelled ())
+            QMessageBox::critical (this, localized ("Error", "Ошибка"),
+                                   localized ("Failed to parse Excel file.", "Не удалось разобрать файл Excel."));
 
         return;
     }
 
     currentFilePath = filePath;
-    priceTags		= parsed;
+    priceTable		= PriceTagTable::fromList (parsed);
+    statistics		= aggregateStatistics ();
+
+    watchFile (filePath);
 
     if (generateButton)
         generateButton->setEnabled (true);
@@ -813,12 +1117,160 @@ void MainWindow::processFile (const QString &filePath)
 }
 
 
+void MainWindow::setupFileWatcher ()
+{
+    fileWatcher = new QFileSystemWatcher (this);
+    reloadTimer = new QTimer (this);
+
+    reloadTimer->setSingleShot (true);
+    reloadTimer->setInterval (reloadDebounceMs);
+
+    connect (fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::onWatchedFileChanged);
+    connect (fileWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::onWatchedDirectoryChanged);
+    connect (reloadTimer, &QTimer::timeout, this, &MainWindow::reloadCurrentFile);
+}
+
+void MainWindow::watchFile (const QString &filePath)
+{
+    if (! fileWatcher->files ().isEmpty ())
+        fileWatcher->removePaths (fileWatcher->files ());
+    if (! fileWatcher->directories ().isEmpty ())
+        fileWatcher->removePaths (fileWatcher->directories ());
+
+    reloadTimer->stop ();
+
+    // The directory is watched too: a save by rename replaces the file, and the watcher drops the old one
+    fileWatcher->addPath (filePath);
+    fileWatcher->addPath (QFileInfo (filePath).absolutePath ());
+}
+
+void MainWindow::onWatchedFileChanged (const QString &path)
+{
+    if (path == currentFilePath)
+        reloadTimer->start ();
+}
+
+void MainWindow::onWatchedDirectoryChanged (const QString &path)
+{
+    Q_UNUSED (path);
+
+    // Only a replaced file matters here; edits in place already arrive through fileChanged
+    if (! currentFilePath.isEmpty () && ! fileWatcher->files ().contains (currentFilePath) && QFileInfo::exists (currentFilePath))
+    {
+        fileWatcher->addPath (currentFilePath);
+        reloadTimer->start ();
+    }
+}
+
+void MainWindow::reloadCurrentFile ()
+{
+    if (currentFilePath.isEmpty () || isStreamingOutput () || ! QFileInfo::exists (currentFilePath))
+        return;
+
+    // Never interrupt a parse the user started; try again once it is over
+    if (excelParser->isParsing ())
+    {
+        reloadTimer->start ();
+
+        return;
+    }
+
+    qDebug () << "Loaded file changed on disk, re-parsing:" << currentFilePath;
+
+    if (! excelParser->parseAsync (currentFilePath))
+        return;
+
+    reloadInProgress = true;
+
+    setParsingUiState (true);
+}
+
+void MainWindow::applyPriceListDelta (const QList<PriceTag> &parsed)
+{
+    const PriceTagDelta delta = priceTable.diff (parsed);
+
+    if (delta.isEmpty ())
+    {
+        qDebug () << "Reloaded price list is unchanged";
+
+        return;
+    }
+
+    qDebug () << "Price list changed:" << delta.addedTags.size () << "rows added or edited," << delta.removedRows.size () << "removed";
+
+
+    // Statistics move by the changed rows only: removed rows are taken back before the table forgets them
+    for (int row : delta.removedRows)
+        accumulateTag (statistics, priceTable.at (row), -1);
+
+    for (const PriceTag &tag : delta.addedTags)
+        accumulateTag (statistics, tag, 1);
+
+    priceTable.applyDelta (delta);
+
+    if (generateButton)
+        generateButton->setEnabled (! priceTable.isEmpty ());
+
+    updateButtonsPrimaryStyles ();
+    showStatistics ();
+}
+
+
+void MainWindow::setParsingUiState (bool parsing)
+{
+    if (progressBar)
+    {
+        progressBar->setRange (0, 0);
+        progressBar->setVisible (parsing);
+    }
+
+    // While loading, the Open button cancels the running parse
+    if (openButton)
+        openButton->setText (parsing ? localized ("Cancel Loading", "Отменить загрузку")
+                                     : localized ("Open Excel File", "Открыть файл Excel"));
+
+    if (generateButton)
+        generateButton->setEnabled (! parsing && ! priceTable.isEmpty ());
+
+    if (allSheetsCheckBox)
+        allSheetsCheckBox->setEnabled (! parsing);
+
+    updateButtonsPrimaryStyles ();
+}
+
+
+void MainWindow::setGeneratingUiState (bool generating)
+{
+    if (progressBar)
+    {
+        progressBar->setRange (0, 0);
+        progressBar->setVisible (generating);
+    }
+
+    // While generating, the Open button cancels the running pipeline
+    if (openButton)
+        openButton->setText (generating ? localized ("Cancel Generation", "Отменить генерацию")
+                                        : localized ("Open Excel File", "Открыть файл Excel"));
+
+    if (generateButton)
+        generateButton->setEnabled (! generating && ! currentFilePath.isEmpty ());
+
+    // The worker reads these settings through wordGenerator: keep them fixed until it is done
+    outputFormatComboBox->setEnabled (! generating);
+    compressionComboBox->setEnabled (! generating && ! isExcelOutput ());
+    tablePerPageCheckBox->setEnabled (! generating && ! isExcelOutput ());
+    allSheetsCheckBox->setEnabled (! generating);
+
+    updateButtonsPrimaryStyles ();
+}
+
+
 void MainWindow::showStatistics ()
 {
     if (! statisticsText)
         return;
 
-    if (priceTags.isEmpty ())
+    if (priceTable.isEmpty ())
         statisticsText->setPlainText (localized ("No data loaded.", "Данные не загружены."));
     else
         statisticsText->setPlainText (buildStatisticsText ());
@@ -850,8 +1302,22 @@ void MainWindow::openTemplateEditor ()
 
 void MainWindow::openFile ()
 {
-    const QString filePath = QFileDialog::getOpenFileName (this, localized ("Open Excel File", "Открыть файл Excel"), QString (),
-                                                           localized ("Excel (*.xlsx)", "Excel (*.xlsx)"));
+    if (pipeline)
+    {
+        pipeline->cancel ();
+
+        return;
+    }
+
+    if (excelParser->isParsing ())
+    {
+        excelParser->cancel ();
+
+        return;
+    }
+
+    const QString filter   = localized ("Price lists (*.xlsx *.csv *.tsv)", "Прайс-листы (*.xlsx *.csv *.tsv)");
+    const QString filePath = QFileDialog::getOpenFileName (this, localized ("Open Excel File", "Открыть файл Excel"), QString (), filter);
     if (filePath.isEmpty ())
         return;
 
@@ -882,35 +1348,36 @@ StatisticsData MainWindow::aggregateStatistics () const
 {
     StatisticsData data;
 
-    data.totalProducts = priceTags.size ();
+    data.totalProducts = priceTable.size ();
+
+    const QVector<Money> &prices	 = priceTable.prices ();
+    const QVector<Money> &prices2	 = priceTable.prices2 ();
+    const QVector<int> &quantities	 = priceTable.quantities ();
 
-    for (const PriceTag &tag : priceTags)
+
+    for (int row = 0; row < priceTable.size (); ++row)
     {
-        const int q = tag.getQuantity ();
+        const int q			= quantities.at (row);
+        const qint64 price	= prices.at (row).minorUnits ();
+        const qint64 price2 = prices2.at (row).minorUnits ();
 
         data.totalTags += q;
 
-        if (tag.hasDiscount ())
+        if (price2 > 0 && price2 < price)
         {
             data.productsWithDiscount++;
-            data.totalDiscountValue += (tag.getPrice () - tag.getPrice2 ()) * q;
+            data.totalDiscountValue += (price - price2) * q;
         }
 
-        const double unit = (tag.getPrice2 () > 0.0 ? tag.getPrice2 () : tag.getPrice ());
+        const qint64 unit = (price2 > 0 ? price2 : price);
 
         data.totalValue += unit * q;
-
-
-        if (! tag.getBrand ().isEmpty ())
-            data.brandCount[tag.getBrand ()]++;
-
-        if (! tag.getCategory ().isEmpty ())
-            data.categoryCount[tag.getCategory ()]++;
-
-        if (! tag.getSupplier ().isEmpty ())
-            data.suppliers.insert (tag.getSupplier ());
     }
 
+    countTextColumn (priceTable, PriceTagTable::Brand, data.brandCount);
+    countTextColumn (priceTable, PriceTagTable::Category, data.categoryCount);
+    countTextColumn (priceTable, PriceTagTable::Supplier, data.supplierCount);
+
 
     return data;
 }
@@ -923,12 +1390,12 @@ QString MainWindow::formatStatisticsText (const StatisticsData &data) const
     text += localized ("=== PRICE TAG STATISTICS ===\n\n", "=== СТАТИСТИКА ПО ЦЕННИКАМ ===\n\n");
     text += localized ("Total Products: %1\n", "Всего товаров: %1\n").arg (data.totalProducts);
     text += localized ("Total Price Tags: %1\n", "Всего ценников: %1\n").arg (data.totalTags);
-    text += localized ("Total Value: %1 ₽\n", "Общая сумма: %1 ₽\n").arg (QString::number (data.totalValue, 'f', 0));
+    text += localized ("Total Value: %1 ₽\n", "Общая сумма: %1 ₽\n").arg (formatRubles (data.totalValue));
     text += localized ("Products with Discount: %1\n", "Товаров со скидкой: %1\n").arg (data.productsWithDiscount);
-    text += localized ("Total Discount Value: %1 ₽\n", "Сумма скидок: %1 ₽\n").arg (QString::number (data.totalDiscountValue, 'f', 0));
+    text += localized ("Total Discount Value: %1 ₽\n", "Сумма скидок: %1 ₽\n").arg (formatRubles (data.totalDiscountValue));
     text += localized ("Unique Brands: %1\n", "Уникальных брендов: %1\n").arg (data.brandCount.size ());
     text += localized ("Unique Categories: %1\n", "Уникальных категорий: %1\n").arg (data.categoryCount.size ());
-    text += localized ("Unique Suppliers: %1\n", "Уникальных поставщиков: %1\n").arg (data.suppliers.size ());
+    text += localized ("Unique Suppliers: %1\n", "Уникальных поставщиков: %1\n").arg (data.supplierCount.size ());
     text += "\n";
     text += localized ("=== BRANDS ===\n", "=== БРЕНДЫ ===\n");
 
@@ -954,7 +1421,7 @@ bool MainWindow::mimeHasXlsx (const QMimeData *mime) const
     const QString path = urls.first ().toLocalFile ();
 
 
-    return path.endsWith (".xlsx", Qt::CaseInsensitive);
+    return ExcelParser::isSupportedFile (path);
 }
 
 
@@ -970,7 +1437,7 @@ QString MainWindow::firstXlsxFromMime (const QMimeData *mime) const
     {
         const QString path = url.toLocalFile ();
 
-        if (path.endsWith (".xlsx", Qt::CaseInsensitive))
+        if (ExcelParser::isSupportedFile (path))
             return path;
     }
 
@@ -1003,7 +1470,7 @@ void MainWindow::clearChartsLayout ()
 void MainWindow::aggregateChartData (QMap<QString, int> &brandCount, QMap<QString, int> &categoryCount, int &totalProducts, int &totalTags,
                                      int &productsWithDiscount) const
 {
-    const StatisticsData data = aggregateStatistics ();
+    const StatisticsData &data = statistics;
 
     totalProducts		 = data.totalProducts;
     totalTags			 = data.totalTags;
@@ -1138,10 +1605,10 @@ void MainWindow::updateCharts ()
 
     clearChartsLayout ();
 
-    if (priceTags.isEmpty ())
+    if (priceTable.isEmpty ())
         return;
 
-    const StatisticsData data = aggregateStatistics ();
+    const StatisticsData &data = statistics;
 
     buildBrandChart (data.brandCount);
     buildCategoryChart (data.categoryCount);
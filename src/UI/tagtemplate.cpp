@@ -9,46 +9,6 @@
 
 namespace
 {
-    QString fieldKey (TagField f)
-    {
-        switch (f)
-        {
-            case TagField::CompanyHeader:
-                return QStringLiteral ("CompanyHeader");
-            case TagField::Brand:
-                return QStringLiteral ("Brand");
-            case TagField::CategoryGender:
-                return QStringLiteral ("CategoryGender");
-            case TagField::BrandCountry:
-                return QStringLiteral ("BrandCountry");
-            case TagField::ManufacturingPlace:
-                return QStringLiteral ("ManufacturingPlace");
-            case TagField::MaterialLabel:
-                return QStringLiteral ("MaterialLabel");
-            case TagField::MaterialValue:
-                return QStringLiteral ("MaterialValue");
-            case TagField::ArticleLabel:
-                return QStringLiteral ("ArticleLabel");
-            case TagField::ArticleValue:
-                return QStringLiteral ("ArticleValue");
-            case TagField::PriceLeft:
-                return QStringLiteral ("PriceLeft");
-            case TagField::PriceRight:
-                return QStringLiteral ("PriceRight");
-            case TagField::Signature:
-                return QStringLiteral ("Signature");
-            case TagField::SupplierLabel:
-                return QStringLiteral ("SupplierLabel");
-            case TagField::SupplierValue:
-                return QStringLiteral ("SupplierValue");
-            case TagField::Address:
-                return QStringLiteral ("Address");
-        }
-
-
-        return QStringLiteral ("Unknown");
-    }
-
     bool keyToField (const QString &key, TagField &out)
     {
         static const QMap<QString, TagField> map = {{QStringLiteral ("CompanyHeader"), TagField::CompanyHeader},
@@ -130,6 +90,47 @@ namespace
 } // namespace
 
 
+QString TagTemplate::fieldKey (TagField f)
+{
+    switch (f)
+    {
+        case TagField::CompanyHeader:
+            return QStringLiteral ("CompanyHeader");
+        case TagField::Brand:
+            return QStringLiteral ("Brand");
+        case TagField::CategoryGender:
+            return QStringLiteral ("CategoryGender");
+        case TagField::BrandCountry:
+            return QStringLiteral ("BrandCountry");
+        case TagField::ManufacturingPlace:
+            return QStringLiteral ("ManufacturingPlace");
+        case TagField::MaterialLabel:
+            return QStringLiteral ("MaterialLabel");
+        case TagField::MaterialValue:
+            return QStringLiteral ("MaterialValue");
+        case TagField::ArticleLabel:
+            return QStringLiteral ("ArticleLabel");
+        case TagField::ArticleValue:
+            return QStringLiteral ("ArticleValue");
+        case TagField::PriceLeft:
+            return QStringLiteral ("PriceLeft");
+        case TagField::PriceRight:
+            return QStringLiteral ("PriceRight");
+        case TagField::Signature:
+            return QStringLiteral ("Signature");
+        case TagField::SupplierLabel:
+            return QStringLiteral ("SupplierLabel");
+        case TagField::SupplierValue:
+            return QStringLiteral ("SupplierValue");
+        case TagField::Address:
+            return QStringLiteral ("Address");
+    }
+
+
+    return QStringLiteral ("Unknown");
+}
+
+
 const TagTextStyle &TagTemplate::styleOrDefault (TagField field) const
 {
     const auto it = styles.constFind (field);
@@ -293,6 +294,7 @@ QJsonObject TagTemplate::toJson () const
     o.insert (QStringLiteral ("marginBottomMm"), marginBottomMm);
     o.insert (QStringLiteral ("spacingHMm"), spacingHMm);
     o.insert (QStringLiteral ("spacingVMm"), spacingVMm);
+    o.insert (QStringLiteral ("priceThousandsGrouping"), priceThousandsGrouping);
 
     QJsonObject stylesObj;
 
@@ -343,6 +345,8 @@ TagTemplate TagTemplate::fromJson (const QJsonObject &o)
     t.spacingHMm	 = o.value (QStringLiteral ("spacingHMm")).toDouble (t.spacingHMm);
     t.spacingVMm	 = o.value (QStringLiteral ("spacingVMm")).toDouble (t.spacingVMm);
 
+    t.priceThousandsGrouping = o.value (QStringLiteral ("priceThousandsGrouping")).toBool (t.priceThousandsGrouping);
+
 
     if (o.contains (QStringLiteral ("styles")) && o.value (QStringLiteral ("styles")).isObject ())
     {
@@ -0,0 +1,238 @@
+#include "XmlEscape.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XML_ESCAPE_SSE2
+#endif
+
+
+namespace
+{
+    inline bool isForbiddenControl (ushort u) { return u < 0x20 && u != 0x09 && u != 0x0A && u != 0x0D; }
+
+    inline bool isMarkup (ushort u) { return u == '&' || u == '<' || u == '>' || u == '"' || u == '\''; }
+
+    // Entity for a markup character, nullptr for anything else
+    inline const char *entityFor (ushort u, int &length)
+    {
+        switch (u)
+        {
+            case '&':
+                length = 5;
+                return "&amp;";
+            case '<':
+                length = 4;
+                return "&lt;";
+            case '>':
+                length = 4;
+                return "&gt;";
+            case '"':
+                length = 6;
+                return "&quot;";
+            case '\'':
+                length = 6;
+                return "&apos;";
+            default:
+                return nullptr;
+        }
+    }
+
+
+#ifdef XML_ESCAPE_SSE2
+    // Lanes (one bit pair per character) holding markup characters
+    inline __m128i markupLanes (__m128i chunk)
+    {
+        const __m128i amp	= _mm_cmpeq_epi16 (chunk, _mm_set1_epi16 ('&'));
+        const __m128i lt	= _mm_cmpeq_epi16 (chunk, _mm_set1_epi16 ('<'));
+        const __m128i gt	= _mm_cmpeq_epi16 (chunk, _mm_set1_epi16 ('>'));
+        const __m128i quot	= _mm_cmpeq_epi16 (chunk, _mm_set1_epi16 ('"'));
+        const __m128i apos	= _mm_cmpeq_epi16 (chunk, _mm_set1_epi16 ('\''));
+
+        return _mm_or_si128 (_mm_or_si128 (_mm_or_si128 (amp, lt), _mm_or_si128 (gt, quot)), apos);
+    }
+
+    // Unsigned 16-bit "a < b" via the sign-bias trick (SSE2 only compares signed)
+    inline __m128i lessThanUnsigned (__m128i a, ushort b)
+    {
+        const __m128i bias = _mm_set1_epi16 (short (0x8000));
+
+        return _mm_cmplt_epi16 (_mm_xor_si128 (a, bias), _mm_set1_epi16 (short (b ^ 0x8000)));
+    }
+#endif
+
+
+    // Characters from p on that can be copied unchanged into a QString (no markup, no control character)
+    int plainRunUtf16 (const QChar *p, int length)
+    {
+        int i = 0;
+
+#ifdef XML_ESCAPE_SSE2
+        for (; i + 8 <= length; i += 8)
+        {
+            const __m128i chunk = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (p + i));
+            const __m128i bad	= _mm_or_si128 (markupLanes (chunk), lessThanUnsigned (chunk, 0x20));
+
+            if (_mm_movemask_epi8 (bad) != 0)
+                break;
+        }
+#endif
+
+        while (i < length && ! isMarkup (p[i].unicode ()) && p[i].unicode () >= 0x20)
+            ++i;
+
+
+        return i;
+    }
+} // namespace
+
+
+void XmlEscape::appendUtf8 (QByteArray &out, const QString &text)
+{
+    const int length = text.size ();
+
+    if (length == 0)
+        return;
+
+
+    // Worst case is "&quot;" (6 bytes) per UTF-16 unit; the array is trimmed to what was written
+    const int start = out.size ();
+    out.resize (start + length * 6);
+
+    char *dst		  = out.data () + start;
+    const QChar *p	  = text.constData ();
+    const QChar *last = p + length;
+
+
+    while (p < last)
+    {
+#ifdef XML_ESCAPE_SSE2
+        // Printable ASCII without markup: 8 characters narrowed to 8 bytes at once
+        while (last - p >= 8)
+        {
+            const __m128i chunk = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (p));
+            const __m128i plain = _mm_sub_epi16 (chunk, _mm_set1_epi16 (0x20));
+            const __m128i bad	= _mm_or_si128 (markupLanes (chunk), _mm_xor_si128 (lessThanUnsigned (plain, 0x60), _mm_set1_epi16 (-1)));
+
+            if (_mm_movemask_epi8 (bad) != 0)
+                break;
+
+            _mm_storel_epi64 (reinterpret_cast<__m128i *> (dst), _mm_packus_epi16 (chunk, chunk));
+            dst += 8;
+            p += 8;
+        }
+
+        if (p == last)
+            break;
+#endif
+
+        const ushort u = p->unicode ();
+
+        if (u < 0x80)
+        {
+            int entityLength   = 0;
+            const char *entity = entityFor (u, entityLength);
+
+            if (entity)
+            {
+                std::memcpy (dst, entity, size_t (entityLength));
+                dst += entityLength;
+            }
+            else if (! isForbiddenControl (u))
+                *dst++ = char (u);
+        }
+        else if (u < 0x800)
+        {
+            *dst++ = char (0xC0 | (u >> 6));
+            *dst++ = char (0x80 | (u & 0x3F));
+        }
+        else if (QChar::isHighSurrogate (u) && p + 1 < last && QChar::isLowSurrogate (p[1].unicode ()))
+        {
+            const uint cp = QChar::surrogateToUcs4 (u, p[1].unicode ());
+            ++p;
+
+            *dst++ = char (0xF0 | (cp >> 18));
+            *dst++ = char (0x80 | ((cp >> 12) & 0x3F));
+            *dst++ = char (0x80 | ((cp >> 6) & 0x3F));
+            *dst++ = char (0x80 | (cp & 0x3F));
+        }
+        else if (QChar::isSurrogate (u))
+            *dst++ = '?';
+        else
+        {
+            *dst++ = char (0xE0 | (u >> 12));
+            *dst++ = char (0x80 | ((u >> 6) & 0x3F));
+            *dst++ = char (0x80 | (u & 0x3F));
+        }
+
+        ++p;
+    }
+
+
+    out.resize (int (dst - out.constData ()));
+}
+
+
+QString XmlEscape::escaped (const QString &text)
+{
+    const QChar *p	 = text.constData ();
+    const int length = text.size ();
+    int i			 = plainRunUtf16 (p, length);
+
+    if (i == length)
+        return text;
+
+
+    QString out;
+    out.reserve (length + 16);
+    out.append (p, i);
+
+    while (i < length)
+    {
+        const ushort u	   = p[i].unicode ();
+        int entityLength   = 0;
+        const char *entity = entityFor (u, entityLength);
+
+        if (entity)
+            out.append (QLatin1String (entity, entityLength));
+        else if (! isForbiddenControl (u))
+            out.append (p[i]);
+
+        ++i;
+
+        const int run = plainRunUtf16 (p + i, length - i);
+        out.append (p + i, run);
+        i += run;
+    }
+
+
+    return out;
+}
+
+QString XmlEscape::sanitized (const QString &text)
+{
+    const QChar *p	 = text.constData ();
+    const int length = text.size ();
+    int i			 = 0;
+
+    while (i < length && ! isForbiddenControl (p[i].unicode ()))
+        ++i;
+
+    if (i == length)
+        return text;
+
+
+    QString out;
+    out.reserve (length);
+    out.append (p, i);
+
+    for (; i < length; ++i)
+    {
+        if (! isForbiddenControl (p[i].unicode ()))
+            out.append (p[i]);
+    }
+
+
+    return out;
+}
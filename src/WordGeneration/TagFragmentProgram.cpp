@@ -0,0 +1,94 @@
+#include "TagFragmentProgram.h"
+
+#include <QDebug>
+
+#include "XmlEscape.h"
+
+
+bool TagFragmentProgram::compile (const QByteArray &renderedXml, int slotCount)
+{
+    clear ();
+
+    if (slotCount < 0 || slotCount > maxSlots)
+        return false;
+
+    const char *data = renderedXml.constData ();
+    const int size	 = renderedXml.size ();
+
+    // Markers U+E000..U+E00F encode as EE 80 80..8F; 0xEE is always a lead byte, so the match is exact
+    int seen[maxSlots] = {};
+    int literalStart   = 0;
+
+    for (int i = 0; i + 2 < size; ++i)
+    {
+        if (uchar (data[i]) != 0xEE || uchar (data[i + 1]) != 0x80 || (uchar (data[i + 2]) & 0xF0) != 0x80)
+            continue;
+
+        const int slot = uchar (data[i + 2]) & 0x0F;
+
+        if (slot >= slotCount || ++seen[slot] > 1)
+        {
+            qDebug () << "Tag template holds a slot marker character; fragment program disabled";
+
+            clear ();
+
+            return false;
+        }
+
+        Op op;
+        op.literalBegin	 = literals.size ();
+        op.literalLength = i - literalStart;
+        op.slot			 = slot;
+
+        literals.append (data + literalStart, op.literalLength);
+        ops.append (op);
+
+        literalStart = i + 3;
+        i += 2;
+    }
+
+    for (int slot = 0; slot < slotCount; ++slot)
+    {
+        if (seen[slot] != 1)
+        {
+            qDebug () << "Tag fragment slot" << slot << "is missing from the template rendering";
+
+            clear ();
+
+            return false;
+        }
+    }
+
+    Op tail;
+    tail.literalBegin  = literals.size ();
+    tail.literalLength = size - literalStart;
+
+    literals.append (data + literalStart, tail.literalLength);
+    ops.append (tail);
+
+    valid = true;
+
+
+    return true;
+}
+
+void TagFragmentProgram::clear ()
+{
+    literals.clear ();
+    ops.clear ();
+    valid = false;
+}
+
+
+void TagFragmentProgram::render (QByteArray &out, const QString *values) const
+{
+    const char *base = literals.constData ();
+
+    for (const Op &op : ops)
+    {
+        out.append (base + op.literalBegin, op.literalLength);
+
+        if (op.slot >= 0)
+            XmlEscape::appendUtf8 (out, values[op.slot]);
+    }
+}
@@ -5,49 +5,24 @@
 #include <QFile>
 #include <QList>
 #include <QString>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
 #include <cmath>
 
-#include <xlsxzipwriter_p.h>
-
+#include "XmlByteBuilder.h"
+#include "ZipStreamWriter.h"
+#include "expandedtagview.h"
 #include "pricetag.h"
-
-
-using namespace QXlsx;
+#include "pricetagtable.h"
 
 
 // ====================================================== Support functions  ======================================================
 
-// Remove XML 1.0 invalid chars: 0x0-0x8, 0xB, 0xC, 0xE-0x1F
-static QString sanitizeForXml (const QString &s)
-{
-    QString out;
-    out.reserve (s.size ());
+// Tags per parallel render window (rounded up to whole pages): large enough to amortize the task overhead
+static const qint64 minRenderWindowTags = 256;
 
-    for (QChar ch : s)
-    {
-        ushort u = ch.unicode ();
-
-        if ((u >= 0x20) || u == 0x09 || u == 0x0A || u == 0x0D)
-            out.append (ch);
-    }
-
-
-    return out;
-}
-
-static QString xmlEscapeLocal (const QString &s)
-{
-    QString out = sanitizeForXml (s);
-
-    out.replace ('&', "&amp;");
-    out.replace ('<', "&lt;");
-    out.replace ('>', "&gt;");
-    out.replace ('\"', "&quot;");
-    out.replace ('\'', "&apos;");
-
-
-    return out;
-}
+// Height of the paragraph between page tables (1 pt); kept free on every page so a full table and the paragraph fit
+static const int pageSeparatorTwips = 20;
 
 
 static inline int ptToTwipsLocal (double pt) { return static_cast<int> (pt * 20.0 + 0.5); }
@@ -55,106 +30,99 @@ static inline int ptToTwipsLocal (double pt) { return static_cast<int> (pt * 20.
 static inline int mmToTwipsLocal (double mm) { return static_cast<int> (mm * 1440.0 / 25.4 + 0.5); }
 
 
-static QString paragraph (const QString &text, const char *align = "left", int sizePt = 11, bool bold = false, bool italic = false,
-                          bool strike = false)
+static void paragraph (XmlByteBuilder &out, const QString &text, const char *align = "left", int sizePt = 11, bool bold = false,
+                       bool italic = false, bool strike = false)
 {
     const int sz = static_cast<int> (sizePt * 2); // w:sz = half-points
-    QString rpr;
 
-    rpr += QString ("<w:rPr><w:rFonts w:ascii=\"Times New Roman\" w:hAnsi=\"Times New Roman\"/>");
+    if (QByteArray (align) == "center")
+        out << "<w:p><w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"center\"/></w:pPr>";
+    else
+        out << "<w:p><w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"left\"/></w:pPr>";
+
+    out << "<w:r><w:rPr><w:rFonts w:ascii=\"Times New Roman\" w:hAnsi=\"Times New Roman\"/>";
 
 
     if (bold)
-        rpr += "<w:b/>";
+        out << "<w:b/>";
 
     if (italic)
-        rpr += "<w:i/>";
+        out << "<w:i/>";
 
     if (strike)
-        rpr += "<w:strike/>";
-
-
-    rpr += QString ("<w:sz w:val=\"%1\"/></w:rPr>").arg (sz);
+        out << "<w:strike/>";
 
-    QString ppr = (QString (align) == "center")
-            ? "<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"center\"/></w:pPr>"
-            : "<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"left\"/></w:pPr>";
 
-
-    return QString ("<w:p>%1<w:r>%2<w:t xml:space=\"preserve\">%3</w:t></w:r></w:p>").arg (ppr, rpr, xmlEscapeLocal (text));
+    out << "<w:sz w:val=\"" << sz << "\"/></w:rPr><w:t xml:space=\"preserve\">";
+    out.text (text) << "</w:t></w:r></w:p>";
 }
 
-static QString paragraphWithStyle (const QString &text, const TagTextStyle &st)
+// Run properties of a tag text style; used for the paragraph styles in styles.xml
+static void runProperties (XmlByteBuilder &out, const TagTextStyle &st)
 {
     const int sz = static_cast<int> (st.fontSizePt * 2);
-    QString rpr;
 
-    rpr += QString ("<w:rPr><w:rFonts w:ascii=\"%1\" w:hAnsi=\"%1\"/>").arg (xmlEscapeLocal (st.fontFamily));
+    out << "<w:rPr><w:rFonts w:ascii=\"";
+    out.text (st.fontFamily) << "\" w:hAnsi=\"";
+    out.text (st.fontFamily) << "\"/>";
 
 
     if (st.bold)
-        rpr += "<w:b/>";
+        out << "<w:b/>";
 
     if (st.italic)
-        rpr += "<w:i/>";
+        out << "<w:i/>";
 
     if (st.strike)
-        rpr += "<w:strike/>";
-
+        out << "<w:strike/>";
 
-    rpr += QString ("<w:sz w:val=\"%1\"/></w:rPr>").arg (sz);
 
-
-    QString ppr;
-
-    if (st.align == TagTextAlign::Center)
-        ppr = "<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"center\"/></w:pPr>";
-    else if (st.align == TagTextAlign::Right)
-        ppr = "<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"right\"/></w:pPr>";
-    else
-    {
-        const int indentTw = mmToTwipsLocal (.5); // .5 mm left indent by default
-
-        ppr = QString ("<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:ind w:left=\"%1\"/><w:jc w:val=\"left\"/></w:pPr>")
-                      .arg (indentTw);
-    }
-
-
-    return QString ("<w:p>%1<w:r>%2<w:t xml:space=\"preserve\">%3</w:t></w:r></w:p>").arg (ppr, rpr, xmlEscapeLocal (text));
+    out << "<w:sz w:val=\"" << sz << "\"/></w:rPr>";
 }
 
-// Same as paragraphWithStyle but without left indent for left-aligned paragraphs
-static QString paragraphWithStyleNoIndent (const QString &text, const TagTextStyle &st)
+// Left-aligned text gets a .5 mm indent unless indentLeft is off
+static void paragraphProperties (XmlByteBuilder &out, TagTextAlign align, bool indentLeft)
 {
-    const int sz = static_cast<int> (st.fontSizePt * 2);
-    QString rpr;
-
-    rpr += QString ("<w:rPr><w:rFonts w:ascii=\"%1\" w:hAnsi=\"%1\"/>").arg (xmlEscapeLocal (st.fontFamily));
-
+    out << "<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/>";
+
+    if (align == TagTextAlign::Center)
+        out << "<w:jc w:val=\"center\"/>";
+    else if (align == TagTextAlign::Right)
+        out << "<w:jc w:val=\"right\"/>";
+    else if (! indentLeft)
+        out << "<w:jc w:val=\"left\"/>";
+    else
+        out << "<w:ind w:left=\"" << mmToTwipsLocal (.5) << "\"/><w:jc w:val=\"left\"/>";
 
-    if (st.bold)
-        rpr += "<w:b/>";
+    out << "</w:pPr>";
+}
 
-    if (st.italic)
-        rpr += "<w:i/>";
 
-    if (st.strike)
-        rpr += "<w:strike/>";
+// Paragraph style ids in styles.xml: one per TagField, plus the two forced variants of the left price cell
+static QString fieldStyleId (TagField field) { return QStringLiteral ("Tag") + TagTemplate::fieldKey (field); }
 
+static const char *const priceOldStyleId   = "TagPriceOld";	 // PriceLeft struck through (discounted tag)
+static const char *const priceLabelStyleId = "TagPriceLabel"; // PriceLeft forced left without indent ("Цена:")
 
-    rpr += QString ("<w:sz w:val=\"%1\"/></w:rPr>").arg (sz);
 
-    QString ppr;
+static void paragraphStyle (XmlByteBuilder &out, const QString &styleId, const TagTextStyle &st, bool indentLeft)
+{
+    out << "<w:style w:type=\"paragraph\" w:customStyle=\"1\" w:styleId=\"";
+    out.text (styleId) << "\"><w:name w:val=\"";
+    out.text (styleId) << "\"/><w:basedOn w:val=\"Normal\"/>";
 
-    if (st.align == TagTextAlign::Center)
-        ppr = "<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"center\"/></w:pPr>";
-    else if (st.align == TagTextAlign::Right)
-        ppr = "<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"right\"/></w:pPr>";
-    else
-        ppr = "<w:pPr><w:keepLines/><w:spacing w:before=\"0\" w:after=\"0\"/><w:jc w:val=\"left\"/></w:pPr>";
+    paragraphProperties (out, st.align, indentLeft);
+    runProperties (out, st);
 
+    out << "</w:style>";
+}
 
-    return QString ("<w:p>%1<w:r>%2<w:t xml:space=\"preserve\">%3</w:t></w:r></w:p>").arg (ppr, rpr, xmlEscapeLocal (text));
+// Formatting comes from the referenced style, so a tag paragraph carries only the style id and the text
+static void paragraphWithStyle (XmlByteBuilder &out, const QString &text, const QString &styleId)
+{
+    out << "<w:p><w:pPr><w:pStyle w:val=\"";
+    out.text (styleId) << "\"/></w:pPr><w:r><w:t xml:space=\"preserve\">";
+    out.text (text) << "</w:t></w:r></w:p>";
 }
 
 
@@ -186,103 +154,101 @@ static QString extractLabelFromTemplate (const QString &tmpl, const QString &fal
 }
 
 
-static QString createMergedTableRow (int heightTwips, const QString &content, int borderSz)
+static void createMergedTableRow (XmlByteBuilder &out, int heightTwips, const QString &text, const QString &styleId, int borderSz)
 {
-    QString tcBorders;
+    out << "<w:tr><w:trPr><w:cantSplit/><w:trHeight w:val=\"" << heightTwips << "\" w:hRule=\"exact\"/></w:trPr>"
+        << "<w:tc><w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/><w:gridSpan w:val=\"4\"/>";
 
     if (borderSz > 0)
-        tcBorders = QString ("<w:tcBorders><w:top w:val=\"single\" w:sz=\"%1\"/><w:bottom w:val=\"single\" w:sz=\"%1\"/></w:tcBorders>")
-                            .arg (borderSz);
-
+        out << "<w:tcBorders><w:top w:val=\"single\" w:sz=\"" << borderSz << "\"/><w:bottom w:val=\"single\" w:sz=\"" << borderSz
+            << "\"/></w:tcBorders>";
 
-    return QString ("<w:tr><w:trPr><w:cantSplit/><w:trHeight w:val=\"%1\" w:hRule=\"exact\"/></w:trPr><w:tc><w:tcPr><w:tcW w:w=\"0\" "
-                    "w:type=\"auto\"/><w:gridSpan w:val=\"4\"/>%2</w:tcPr>%3</w:tc></w:tr>")
-            .arg (heightTwips)
-            .arg (tcBorders)
-            .arg (content);
+    out << "</w:tcPr>";
+    paragraphWithStyle (out, text, styleId);
+    out << "</w:tc></w:tr>";
 }
 
-static QString createTwoCellTableRow (int heightTwips, const QString &leftContent, const QString &rightContent, bool diagonalBL2TR,
-                                      bool rightThickBorder, int borderSz)
+static void createTwoCellTableRow (XmlByteBuilder &out, int heightTwips, const QString &leftText, const QString &leftStyleId,
+                                   const QString &rightText, const QString &rightStyleId, bool diagonalBL2TR, bool rightThickBorder,
+                                   int borderSz)
 {
+    out << "<w:tr><w:trPr><w:cantSplit/><w:trHeight w:val=\"" << heightTwips << "\" w:hRule=\"exact\"/></w:trPr>";
+
+
     // Left cell spans 1 column; right spans 3 columns
-    QString leftBorders;
+    out << "<w:tc><w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/>";
 
-    if (diagonalBL2TR)
-        leftBorders += "<w:tr2bl w:val=\"single\" w:sz=\"8\"/>";
+    if (diagonalBL2TR || borderSz > 0)
+    {
+        out << "<w:tcBorders>";
 
-    if (borderSz > 0)
-        leftBorders += QString ("<w:top w:val=\"single\" w:sz=\"%1\"/><w:bottom w:val=\"single\" w:sz=\"%1\"/>").arg (borderSz);
+        if (diagonalBL2TR)
+            out << "<w:tr2bl w:val=\"single\" w:sz=\"8\"/>";
 
-    QString leftTcPr = QString ("<w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/>") +
-            (leftBorders.isEmpty () ? QString () : QString ("<w:tcBorders>%1</w:tcBorders>").arg (leftBorders)) + "</w:tcPr>";
+        if (borderSz > 0)
+            out << "<w:top w:val=\"single\" w:sz=\"" << borderSz << "\"/><w:bottom w:val=\"single\" w:sz=\"" << borderSz << "\"/>";
 
+        out << "</w:tcBorders>";
+    }
+
+    out << "</w:tcPr>";
+    paragraphWithStyle (out, leftText, leftStyleId);
+    out << "</w:tc>";
 
-    QString rightTcPr = "<w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/><w:gridSpan w:val=\"3\"/>";
 
+    out << "<w:tc><w:tcPr><w:tcW w:w=\"0\" w:type=\"auto\"/><w:gridSpan w:val=\"3\"/>";
 
     if (rightThickBorder)
-        rightTcPr += "<w:tcBorders><w:top w:val=\"single\" w:sz=\"12\"/><w:left w:val=\"single\" w:sz=\"12\"/>"
-                     "<w:bottom w:val=\"single\" w:sz=\"12\"/><w:right w:val=\"single\" w:sz=\"12\"/></w:tcBorders>";
+        out << "<w:tcBorders><w:top w:val=\"single\" w:sz=\"12\"/><w:left w:val=\"single\" w:sz=\"12\"/>"
+               "<w:bottom w:val=\"single\" w:sz=\"12\"/><w:right w:val=\"single\" w:sz=\"12\"/></w:tcBorders>";
     else if (borderSz > 0)
-        rightTcPr += QString ("<w:tcBorders><w:top w:val=\"single\" w:sz=\"%1\"/><w:bottom w:val=\"single\" w:sz=\"%1\"/></w:tcBorders>")
-                             .arg (borderSz);
-    rightTcPr += "</w:tcPr>";
+        out << "<w:tcBorders><w:top w:val=\"single\" w:sz=\"" << borderSz << "\"/><w:bottom w:val=\"single\" w:sz=\"" << borderSz
+            << "\"/></w:tcBorders>";
 
-
-    return QString ("<w:tr><w:trPr><w:cantSplit/><w:trHeight w:val=\"%1\" w:hRule=\"exact\"/></w:trPr>"
-                    "<w:tc>%2%3</w:tc>"
-                    "<w:tc>%4%5</w:tc>"
-                    "</w:tr>")
-            .arg (heightTwips)
-            .arg (leftTcPr)
-            .arg (leftContent)
-            .arg (rightTcPr)
-            .arg (rightContent);
+    out << "</w:tcPr>";
+    paragraphWithStyle (out, rightText, rightStyleId);
+    out << "</w:tc></w:tr>";
 }
 
-static QString createTableStructure (int tableWidth)
+static void createTableStructure (XmlByteBuilder &out, int tableWidth)
 {
-    QString xml;
-
-    xml += "<w:tbl><w:tblPr><w:tblW w:w=\"%1\" w:type=\"dxa\"/><w:tblLayout w:type=\"fixed\"/>";
-    xml = xml.arg (tableWidth);
-    xml += "<w:tblCellMar><w:top w:w=\"0\" w:type=\"dxa\"/><w:left w:w=\"0\" w:type=\"dxa\"/><w:bottom w:w=\"0\" w:type=\"dxa\"/><w:right "
+    out << "<w:tbl><w:tblPr><w:tblW w:w=\"" << tableWidth << "\" w:type=\"dxa\"/><w:tblLayout w:type=\"fixed\"/>";
+    out << "<w:tblCellMar><w:top w:w=\"0\" w:type=\"dxa\"/><w:left w:w=\"0\" w:type=\"dxa\"/><w:bottom w:w=\"0\" w:type=\"dxa\"/><w:right "
            "w:w=\"0\" w:type=\"dxa\"/></w:tblCellMar><w:tblBorders>";
-    xml += "<w:top w:val=\"single\" w:sz=\"8\"/><w:left w:val=\"single\" w:sz=\"8\"/><w:bottom w:val=\"single\" w:sz=\"8\"/><w:right "
+    out << "<w:top w:val=\"single\" w:sz=\"8\"/><w:left w:val=\"single\" w:sz=\"8\"/><w:bottom w:val=\"single\" w:sz=\"8\"/><w:right "
            "w:val=\"single\" w:sz=\"8\"/>";
-    xml += "<w:insideH w:val=\"single\" w:sz=\"4\"/><w:insideV w:val=\"single\" w:sz=\"4\"/></w:tblBorders></w:tblPr>";
-
-
-    return xml;
+    out << "<w:insideH w:val=\"single\" w:sz=\"4\"/><w:insideV w:val=\"single\" w:sz=\"4\"/></w:tblBorders></w:tblPr>";
 }
 
-static QString createTableGrid (const int colTw[4])
+static void createTableGrid (XmlByteBuilder &out, const int colTw[4])
 {
-    QString xml = "<w:tblGrid>";
+    out << "<w:tblGrid>";
 
     for (int i = 0; i < 4; ++i)
-        xml += QString ("<w:gridCol w:w=\"%1\"/>").arg (colTw[i]);
-    xml += "</w:tblGrid>";
-
-
-    return xml;
+        out << "<w:gridCol w:w=\"" << colTw[i] << "\"/>";
+    out << "</w:tblGrid>";
 }
 
 
-static QString addCompanyHeaderRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
+// Per-tag values of the inner table, in fragment slot order. Price2 is last: the regular variant has no slot for it
+enum TagSlot
 {
-    return createMergedTableRow (
-            ptToTwipsLocal (rowHeightPt),
-            paragraphWithStyle (tpl.textOrDefault (TagField::CompanyHeader), tpl.styleOrDefault (TagField::CompanyHeader)), 4);
-}
+    SlotBrand,
+    SlotCategory,
+    SlotBrandCountry,
+    SlotManufacturingPlace,
+    SlotMaterial,
+    SlotArticle,
+    SlotSupplier,
+    SlotAddressLine1,
+    SlotAddressLine2,
+    SlotPrice,
+    SlotPrice2,
+    TagSlotCount
+};
 
-static QString addBrandRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
-{
-    return createMergedTableRow (ptToTwipsLocal (rowHeightPt), paragraphWithStyle (t.getBrand (), tpl.styleOrDefault (TagField::Brand)), 4);
-}
 
-static QString addCategoryRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
+static QString categoryText (const PriceTag &t)
 {
     QString category	= t.getCategory ();
     bool appendedGender = false;
@@ -297,97 +263,92 @@ static QString addCategoryRow (const PriceTag &t, const TagTemplate &tpl, double
         category += " " + t.getSize ();
 
 
-    return createMergedTableRow (ptToTwipsLocal (rowHeightPt), paragraphWithStyle (category, tpl.styleOrDefault (TagField::CategoryGender)),
-                                 4);
+    return category;
+}
+
+
+static void addCompanyHeaderRow (XmlByteBuilder &out, const TagTemplate &tpl, double rowHeightPt)
+{
+    createMergedTableRow (out, ptToTwipsLocal (rowHeightPt), tpl.textOrDefault (TagField::CompanyHeader),
+                          fieldStyleId (TagField::CompanyHeader), 4);
+}
+
+static void addBrandRow (XmlByteBuilder &out, const QString *v, double rowHeightPt)
+{
+    createMergedTableRow (out, ptToTwipsLocal (rowHeightPt), v[SlotBrand], fieldStyleId (TagField::Brand), 4);
+}
+
+static void addCategoryRow (XmlByteBuilder &out, const QString *v, double rowHeightPt)
+{
+    createMergedTableRow (out, ptToTwipsLocal (rowHeightPt), v[SlotCategory], fieldStyleId (TagField::CategoryGender), 4);
 }
 
-static QString addBrandCountryRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
+static void addBrandCountryRow (XmlByteBuilder &out, const QString *v, const TagTemplate &tpl, double rowHeightPt)
 {
     const QString label = extractLabelFromTemplate (tpl.textOrDefault (TagField::BrandCountry), QString::fromUtf8 ("Страна:"));
 
-    return createMergedTableRow (ptToTwipsLocal (rowHeightPt),
-                                 paragraphWithStyle (label + " " + t.getBrandCountry (), tpl.styleOrDefault (TagField::BrandCountry)), 4);
+    createMergedTableRow (out, ptToTwipsLocal (rowHeightPt), label + " " + v[SlotBrandCountry], fieldStyleId (TagField::BrandCountry), 4);
 }
 
-static QString addManufacturingPlaceRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
+static void addManufacturingPlaceRow (XmlByteBuilder &out, const QString *v, const TagTemplate &tpl, double rowHeightPt)
 {
     const QString label = extractLabelFromTemplate (tpl.textOrDefault (TagField::ManufacturingPlace), QString::fromUtf8 ("Место:"));
 
-    return createMergedTableRow (
-            ptToTwipsLocal (rowHeightPt),
-            paragraphWithStyle (label + " " + t.getManufacturingPlace (), tpl.styleOrDefault (TagField::ManufacturingPlace)), 4);
+    createMergedTableRow (out, ptToTwipsLocal (rowHeightPt), label + " " + v[SlotManufacturingPlace],
+                          fieldStyleId (TagField::ManufacturingPlace), 4);
 }
 
-static QString addMaterialRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
+static void addMaterialRow (XmlByteBuilder &out, const QString *v, const TagTemplate &tpl, double rowHeightPt)
 {
     const QString label = extractLabelFromTemplate (tpl.textOrDefault (TagField::MaterialLabel), QString::fromUtf8 ("Матер-л:"));
-    QString left		= paragraphWithStyle (label, tpl.styleOrDefault (TagField::MaterialLabel));
-    QString right		= paragraphWithStyle (t.getMaterial (), tpl.styleOrDefault (TagField::MaterialValue));
-
 
-    return createTwoCellTableRow (ptToTwipsLocal (rowHeightPt), left, right, false, false, 4);
+    createTwoCellTableRow (out, ptToTwipsLocal (rowHeightPt), label, fieldStyleId (TagField::MaterialLabel), v[SlotMaterial],
+                           fieldStyleId (TagField::MaterialValue), false, false, 4);
 }
 
-static QString addArticleRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
+static void addArticleRow (XmlByteBuilder &out, const QString *v, const TagTemplate &tpl, double rowHeightPt)
 {
     const QString label = extractLabelFromTemplate (tpl.textOrDefault (TagField::ArticleLabel), QString::fromUtf8 ("Артикул:"));
-    QString left		= paragraphWithStyle (label, tpl.styleOrDefault (TagField::ArticleLabel));
-    QString right		= paragraphWithStyle (t.getArticle (), tpl.styleOrDefault (TagField::ArticleValue));
 
-
-    return createTwoCellTableRow (ptToTwipsLocal (rowHeightPt), left, right, false, false, 2);
+    createTwoCellTableRow (out, ptToTwipsLocal (rowHeightPt), label, fieldStyleId (TagField::ArticleLabel), v[SlotArticle],
+                           fieldStyleId (TagField::ArticleValue), false, false, 2);
 }
 
-static QString addPriceRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
+static void addPriceRow (XmlByteBuilder &out, const QString *v, bool discounted, double rowHeightPt)
 {
-    if (t.getPrice2 () > 0)
-    { // Left cell: old price number only with strike and diagonal TL->BR
+    const QString rightStyleId = fieldStyleId (TagField::PriceRight);
 
-        TagTextStyle leftSt = tpl.styleOrDefault (TagField::PriceLeft);
-        leftSt.strike		= true;
-
-        QString leftContent = paragraphWithStyle (QString::number (t.getPrice (), 'f', 0), leftSt);
-        QString rightContent =
-                paragraphWithStyle (QString::number (t.getPrice2 (), 'f', 0) + " =", tpl.styleOrDefault (TagField::PriceRight));
-
-
-        return createTwoCellTableRow (ptToTwipsLocal (rowHeightPt), leftContent, rightContent, true, true, 0);
+    if (discounted)
+    { // Left cell: old price number only with strike and diagonal TL->BR
+        createTwoCellTableRow (out, ptToTwipsLocal (rowHeightPt), v[SlotPrice], QString (priceOldStyleId), v[SlotPrice2] + " =",
+                               rightStyleId, true, true, 0);
     }
     else
     { // Left cell: forced label "Цена:"; Right cell: current price
-        TagTextStyle leftSt = tpl.styleOrDefault (TagField::PriceLeft);
-        leftSt.align		= TagTextAlign::Left; // force left alignment
-
-        QString leftContent = paragraphWithStyleNoIndent (QString::fromUtf8 ("Цена: "), leftSt);
-        QString rightContent =
-                paragraphWithStyle (QString::number (t.getPrice (), 'f', 0) + " =", tpl.styleOrDefault (TagField::PriceRight));
-
-
-        return createTwoCellTableRow (ptToTwipsLocal (rowHeightPt), leftContent, rightContent, false, true, 0);
+        createTwoCellTableRow (out, ptToTwipsLocal (rowHeightPt), QString::fromUtf8 ("Цена: "), QString (priceLabelStyleId),
+                               v[SlotPrice] + " =", rightStyleId, false, true, 0);
     }
 }
 
-static QString addSupplierRow (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt)
+static void addSupplierRow (XmlByteBuilder &out, const QString *v, const TagTemplate &tpl, double rowHeightPt)
 {
     const QString label = extractLabelFromTemplate (tpl.textOrDefault (TagField::SupplierLabel), QString::fromUtf8 ("Поставщик:"));
-    QString left		= paragraphWithStyle (label, tpl.styleOrDefault (TagField::SupplierLabel));
-    QString right		= paragraphWithStyle (t.getSupplier (), tpl.styleOrDefault (TagField::SupplierValue));
 
-    return createTwoCellTableRow (ptToTwipsLocal (rowHeightPt), left, right, false, false, 2);
+    createTwoCellTableRow (out, ptToTwipsLocal (rowHeightPt), label, fieldStyleId (TagField::SupplierLabel), v[SlotSupplier],
+                           fieldStyleId (TagField::SupplierValue), false, false, 2);
 }
 
 
-static QString createAddressTableRow (const QString &addressText, double rowHeightPt, const TagTemplate &tpl, int borderSz = 2)
+static void createAddressTableRow (XmlByteBuilder &out, const QString &addressText, double rowHeightPt, int borderSz = 2)
 {
-    return createMergedTableRow (ptToTwipsLocal (rowHeightPt), paragraphWithStyle (addressText, tpl.styleOrDefault (TagField::Address)),
-                                 borderSz);
+    createMergedTableRow (out, ptToTwipsLocal (rowHeightPt), addressText, fieldStyleId (TagField::Address), borderSz);
 }
 
-static QString createTableCellProperties (int tagWidth)
+static void createTableCellProperties (XmlByteBuilder &out, int tagWidth)
 {
-    return QString ("<w:tc><w:tcPr><w:tcW w:w=\"%1\" w:type=\"dxa\"/><w:tcMar><w:top w:w=\"0\" w:type=\"dxa\"/><w:left w:w=\"0\" "
-                    "w:type=\"dxa\"/><w:bottom w:w=\"0\" w:type=\"dxa\"/><w:right w:w=\"0\" w:type=\"dxa\"/></w:tcMar></w:tcPr>")
-            .arg (tagWidth);
+    out << "<w:tc><w:tcPr><w:tcW w:w=\"" << tagWidth
+        << "\" w:type=\"dxa\"/><w:tcMar><w:top w:w=\"0\" w:type=\"dxa\"/><w:left w:w=\"0\" w:type=\"dxa\"/><w:bottom w:w=\"0\" "
+           "w:type=\"dxa\"/><w:right w:w=\"0\" w:type=\"dxa\"/></w:tcMar></w:tcPr>";
 }
 
 
@@ -441,21 +402,40 @@ static AddressLines splitAddressIntoLines (const QString &address)
 }
 
 
-static QString addAddressRows (const PriceTag &t, const TagTemplate &tpl, double rowHeightPt1, double rowHeightPt2)
+static void addAddressRows (XmlByteBuilder &out, const QString *v, double rowHeightPt1, double rowHeightPt2)
 {
-    // Split address into two lines with proper text wrapping
-    const AddressLines lines = splitAddressIntoLines (t.getAddress ());
-
-    QString xml;
-    xml += createAddressTableRow (lines.line1, rowHeightPt1, tpl, 2);
-    xml += createAddressTableRow (lines.line2, rowHeightPt2, tpl, 2);
+    createAddressTableRow (out, v[SlotAddressLine1], rowHeightPt1, 2);
+    createAddressTableRow (out, v[SlotAddressLine2], rowHeightPt2, 2);
+}
 
 
-    return xml;
+// Slot values of one tag; the price row takes the discounted layout when price2 is set
+static bool collectTagValues (const PriceTag &t, const TagTemplate &tpl, QString *v)
+{
+    // Split address into two lines with proper text wrapping
+    const AddressLines lines = splitAddressIntoLines (t.getAddress ());
+    const bool grouping		 = tpl.priceThousandsGrouping;
+    const bool discounted	 = t.getPrice2Money ().isPositive ();
+
+    v[SlotBrand]			  = t.getBrand ();
+    v[SlotCategory]			  = categoryText (t);
+    v[SlotBrandCountry]		  = t.getBrandCountry ();
+    v[SlotManufacturingPlace] = t.getManufacturingPlace ();
+    v[SlotMaterial]			  = t.getMaterial ();
+    v[SlotArticle]			  = t.getArticle ();
+    v[SlotSupplier]			  = t.getSupplier ();
+    v[SlotAddressLine1]		  = lines.line1;
+    v[SlotAddressLine2]		  = lines.line2;
+    v[SlotPrice]			  = t.getPriceMoney ().toString (grouping);
+    v[SlotPrice2]			  = discounted ? t.getPrice2Money ().toString (grouping) : QString ();
+
+
+    return discounted;
 }
 
 
-static QString makeInnerTagTable (const PriceTag &t, const TagTemplate &tpl, int outerCellWidthTwips)
+// Reference rendering of one tag; also run once with slot markers as values to compile the fragment programs
+static void makeInnerTagTable (XmlByteBuilder &out, const QString *v, bool discounted, const TagTemplate &tpl, int outerCellWidthTwips)
 {
     // Default heights in points for 11 rows
     const double pt[11] = {16.50, 16.50, 16.50, 12.75, 12.75, 12.75, 15.75, 16.50, 13.50, 9.75, 9.75};
@@ -478,25 +458,21 @@ static QString makeInnerTagTable (const PriceTag &t, const TagTemplate &tpl, int
     colTw[3] = qMax (1, targetWidth - (colTw[0] + colTw[1] + colTw[2]));
 
 
-    QString xml = createTableStructure (targetWidth);
-
-    xml += createTableGrid (colTw);
-
-    xml += addCompanyHeaderRow (t, tpl, pt[0]);
-    xml += addBrandRow (t, tpl, pt[1]);
-    xml += addCategoryRow (t, tpl, pt[2]);
-    xml += addBrandCountryRow (t, tpl, pt[3]);
-    xml += addManufacturingPlaceRow (t, tpl, pt[4]);
-    xml += addMaterialRow (t, tpl, pt[5]);
-    xml += addArticleRow (t, tpl, pt[6]);
-    xml += addPriceRow (t, tpl, pt[7]);
-    xml += addSupplierRow (t, tpl, pt[8]);
-    xml += addAddressRows (t, tpl, pt[9], pt[10]);
-
-    xml += "</w:tbl>";
+    createTableStructure (out, targetWidth);
+    createTableGrid (out, colTw);
 
+    addCompanyHeaderRow (out, tpl, pt[0]);
+    addBrandRow (out, v, pt[1]);
+    addCategoryRow (out, v, pt[2]);
+    addBrandCountryRow (out, v, tpl, pt[3]);
+    addManufacturingPlaceRow (out, v, tpl, pt[4]);
+    addMaterialRow (out, v, tpl, pt[5]);
+    addArticleRow (out, v, tpl, pt[6]);
+    addPriceRow (out, v, discounted, pt[7]);
+    addSupplierRow (out, v, tpl, pt[8]);
+    addAddressRows (out, v, pt[9], pt[10]);
 
-    return xml;
+    out << "</w:tbl>";
 }
 
 // ================================================================================================================================
@@ -504,24 +480,7 @@ static QString makeInnerTagTable (const PriceTag &t, const TagTemplate &tpl, int
 
 WordGenerator::WordGenerator (QObject *parent) : QObject (parent) {}
 
-WordGenerator::~WordGenerator () {}
-
-
-static QList<PriceTag> expandByQuantity (const QList<PriceTag> &src)
-{
-    QList<PriceTag> out;
-
-    for (const PriceTag &t : src)
-    {
-        const int q = std::max (1, t.getQuantity ());
-
-        for (int i = 0; i < q; ++i)
-            out.append (t);
-    }
-
-
-    return out;
-}
+WordGenerator::~WordGenerator () { cancelStream (); }
 
 
 void WordGenerator::computeGrid (const DocxLayoutConfig &cfg, int &nCols, int &nRows)
@@ -529,7 +488,7 @@ void WordGenerator::computeGrid (const DocxLayoutConfig &cfg, int &nCols, int &n
     const double pageW	= 210.0;
     const double pageH	= 297.0;
     const double availW = pageW - cfg.marginLeftMm - cfg.marginRightMm;
-    const double availH = pageH - cfg.marginTopMm - cfg.marginBottomMm;
+    const double availH = pageH - cfg.marginTopMm - cfg.marginBottomMm - (cfg.tablePerPage ? pageSeparatorTwips * 25.4 / 1440.0 : 0.0);
 
     nCols = std::max (1, static_cast<int> (std::floor ((availW + cfg.spacingHMm) / (cfg.tagWidthMm + cfg.spacingHMm))));
     nRows = std::max (1, static_cast<int> (std::floor ((availH + cfg.spacingVMm) / (cfg.tagHeightMm + cfg.spacingVMm))));
@@ -537,6 +496,11 @@ void WordGenerator::computeGrid (const DocxLayoutConfig &cfg, int &nCols, int &n
 
 
 bool WordGenerator::generateWordDocument (const QList<PriceTag> &priceTags, const QString &outputPath)
+{
+    return generateWordDocument (PriceTagTable::fromList (priceTags), outputPath);
+}
+
+bool WordGenerator::generateWordDocument (const PriceTagTable &priceTags, const QString &outputPath)
 {
     if (priceTags.isEmpty ())
     {
@@ -545,32 +509,162 @@ bool WordGenerator::generateWordDocument (const QList<PriceTag> &priceTags, cons
         return false;
     }
 
-    const QList<PriceTag> expanded = expandByQuantity (priceTags);
+    const ExpandedTagView expanded (priceTags);
+
+
+    ZipStreamWriter zip (outputPath, compression);
+    if (zip.hasError ())
+    {
+        qDebug () << "Failed to open DOCX for writing:" << outputPath;
+
+        return false;
+    }
+
+    writePackageParts (zip);
+
+    bool ok = writeDocumentXml (zip, expanded);
+    ok		= zip.close () && ok;
+
+    if (! ok)
+        QFile::remove (outputPath);
+
+
+    return ok;
+}
+
+
+bool WordGenerator::beginStream (const QString &outputPath)
+{
+    cancelStream ();
 
+    streamPath = outputPath;
+    stream	   = new ZipStreamWriter (outputPath, compression);
 
-    ZipWriter zip (outputPath);
-    if (zip.error ())
+    if (stream->hasError ())
     {
         qDebug () << "Failed to open DOCX for writing:" << outputPath;
 
+        cancelStream ();
+
+        return false;
+    }
+
+    streamDims			= calculateDocumentDimensions (layoutConfig);
+    streamedTagCount	= 0;
+    streamedRowCount	= 0;
+    streamPageSeparator = layoutConfig.tablePerPage ? createPageSeparator (streamDims) : QByteArray ();
+    streamRow.clear ();
+
+    compileTagPrograms (streamDims.tagWidth);
+
+    writePackageParts (*stream);
+
+
+    // document.xml stays the open entry until finishStream
+    if (! stream->beginEntry ("word/document.xml") || ! stream->writeEntryData (createDocumentHead (streamDims)))
+    {
+        cancelStream ();
+
+        return false;
+    }
+
+
+    return true;
+}
+
+bool WordGenerator::streamTag (const PriceTag &tag)
+{
+    if (! stream)
+        return false;
+
+    const int q				  = std::max (1, tag.getQuantity ());
+    const QByteArray fragment = renderTag (tag); // copies share the bytes
+
+    for (int i = 0; i < q; ++i)
+    {
+        streamRow.append (fragment);
+        ++streamedTagCount;
+
+        if (streamRow.size () == streamDims.columns && ! writeStreamRow ())
+            return false;
+    }
+
+
+    return true;
+}
+
+bool WordGenerator::writeStreamRow ()
+{
+    QByteArray xml;
+
+    if (! streamPageSeparator.isEmpty () && streamedRowCount > 0 && streamedRowCount % streamDims.rows == 0)
+        xml += streamPageSeparator;
+
+    appendTableRow (xml, streamRow, streamDims.columns);
+
+    streamRow.clear ();
+    ++streamedRowCount;
+
+
+    return stream->writeEntryData (xml);
+}
+
+bool WordGenerator::finishStream ()
+{
+    if (! stream)
+        return false;
+
+    if (streamedTagCount == 0)
+    {
+        qDebug () << "No price tags to generate";
+
+        cancelStream ();
+
         return false;
     }
 
+    bool ok = streamRow.isEmpty () || writeStreamRow ();
+
+    ok = ok && stream->writeEntryData (createDocumentTail (streamDims)) && stream->endEntry ();
+    ok = stream->close () && ok;
+
+    delete stream;
+    stream = nullptr;
+
+    if (! ok)
+        QFile::remove (streamPath);
+
+
+    return ok;
+}
+
+void WordGenerator::cancelStream ()
+{
+    if (! stream)
+        return;
+
+    // A half-written package is not a valid document
+    stream->close ();
+
+    delete stream;
+    stream = nullptr;
+
+    QFile::remove (streamPath);
+    streamRow.clear ();
+}
+
+
+void WordGenerator::writePackageParts (ZipStreamWriter &zip)
+{
     writeContentTypes (zip);
     writeRelsRoot (zip);
     writeDocProps (zip);
     writeStyles (zip);
     writeSettings (zip);
-    writeDocumentXml (zip, expanded);
-
-    zip.close ();
-
-
-    return true;
 }
 
 
-void WordGenerator::writeContentTypes (ZipWriter &zip)
+void WordGenerator::writeContentTypes (ZipStreamWriter &zip)
 {
     const char *xml =
             "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
@@ -591,7 +685,7 @@ void WordGenerator::writeContentTypes (ZipWriter &zip)
     zip.addFile ("[Content_Types].xml", QByteArray (xml));
 }
 
-void WordGenerator::writeRelsRoot (ZipWriter &zip)
+void WordGenerator::writeRelsRoot (ZipStreamWriter &zip)
 {
     const char *rels =
             "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
@@ -618,21 +712,23 @@ void WordGenerator::writeRelsRoot (ZipWriter &zip)
     zip.addFile ("word/_rels/document.xml.rels", QByteArray (docRels));
 }
 
-void WordGenerator::writeDocProps (ZipWriter &zip)
+void WordGenerator::writeDocProps (ZipStreamWriter &zip)
 {
-    const QString core = QString ("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
-                                  "<cp:coreProperties xmlns:cp=\"http://schemas.openxmlformats.org/package/2006/metadata/core-properties\" "
-                                  "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" xmlns:dcterms=\"http://purl.org/dc/terms/\" "
-                                  "xmlns:dcmitype=\"http://purl.org/dc/dcmitype/\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">"
-                                  "<dc:title>Price Tags</dc:title>"
-                                  "<dc:creator>PriceTagMaster</dc:creator>"
-                                  "<cp:lastModifiedBy>PriceTagMaster</cp:lastModifiedBy>"
-                                  "<dcterms:created xsi:type=\"dcterms:W3CDTF\">%1</dcterms:created>"
-                                  "<dcterms:modified xsi:type=\"dcterms:W3CDTF\">%1</dcterms:modified>"
-                                  "</cp:coreProperties>")
-                                 .arg (QDateTime::currentDateTimeUtc ().toString (Qt::ISODate));
+    const QString now = QDateTime::currentDateTimeUtc ().toString (Qt::ISODate);
+    XmlByteBuilder core (1024);
 
-    zip.addFile ("docProps/core.xml", core.toUtf8 ());
+    core << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
+            "<cp:coreProperties xmlns:cp=\"http://schemas.openxmlformats.org/package/2006/metadata/core-properties\" "
+            "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" xmlns:dcterms=\"http://purl.org/dc/terms/\" "
+            "xmlns:dcmitype=\"http://purl.org/dc/dcmitype/\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">"
+            "<dc:title>Price Tags</dc:title>"
+            "<dc:creator>PriceTagMaster</dc:creator>"
+            "<cp:lastModifiedBy>PriceTagMaster</cp:lastModifiedBy>"
+            "<dcterms:created xsi:type=\"dcterms:W3CDTF\">";
+    core.text (now) << "</dcterms:created><dcterms:modified xsi:type=\"dcterms:W3CDTF\">";
+    core.text (now) << "</dcterms:modified></cp:coreProperties>";
+
+    zip.addFile ("docProps/core.xml", core.take ());
 
 
     const char *app = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
@@ -644,20 +740,36 @@ void WordGenerator::writeDocProps (ZipWriter &zip)
     zip.addFile ("docProps/app.xml", QByteArray (app));
 }
 
-void WordGenerator::writeStyles (ZipWriter &zip)
+void WordGenerator::writeStyles (ZipStreamWriter &zip)
 {
-    const char *styles = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
-                         "<w:styles xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">"
-                         "<w:style w:type=\"paragraph\" w:default=\"1\" w:styleId=\"Normal\">"
-                         "  <w:name w:val=\"Normal\"/>"
-                         "  <w:rPr><w:rFonts w:ascii=\"Times New Roman\" w:hAnsi=\"Times New Roman\"/><w:sz w:val=\"22\"/></w:rPr>"
-                         "</w:style>"
-                         "</w:styles>";
+    XmlByteBuilder styles (8 * 1024);
+
+    styles << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
+              "<w:styles xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">"
+              "<w:style w:type=\"paragraph\" w:default=\"1\" w:styleId=\"Normal\">"
+              "  <w:name w:val=\"Normal\"/>"
+              "  <w:rPr><w:rFonts w:ascii=\"Times New Roman\" w:hAnsi=\"Times New Roman\"/><w:sz w:val=\"22\"/></w:rPr>"
+              "</w:style>";
+
+
+    // Tag paragraphs reference these by w:pStyle instead of repeating pPr/rPr inline
+    for (TagField field : TagTemplate::allFields ())
+        paragraphStyle (styles, fieldStyleId (field), tagTemplate.styleOrDefault (field), true);
 
-    zip.addFile ("word/styles.xml", QByteArray (styles));
+    TagTextStyle priceOld = tagTemplate.styleOrDefault (TagField::PriceLeft);
+    priceOld.strike		  = true;
+    paragraphStyle (styles, QString (priceOldStyleId), priceOld, true);
+
+    TagTextStyle priceLabel = tagTemplate.styleOrDefault (TagField::PriceLeft);
+    priceLabel.align		= TagTextAlign::Left;
+    paragraphStyle (styles, QString (priceLabelStyleId), priceLabel, false);
+
+    styles << "</w:styles>";
+
+    zip.addFile ("word/styles.xml", styles.take ());
 }
 
-void WordGenerator::writeSettings (ZipWriter &zip)
+void WordGenerator::writeSettings (ZipStreamWriter &zip)
 {
     const char *settings = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
                            "<w:settings xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">"
@@ -667,80 +779,122 @@ void WordGenerator::writeSettings (ZipWriter &zip)
     zip.addFile ("word/settings.xml", QByteArray (settings));
 }
 
-void WordGenerator::writeDocumentXml (ZipWriter &zip, const QList<PriceTag> &expandedTags)
+bool WordGenerator::writeDocumentXml (ZipStreamWriter &zip, const ExpandedTagView &expandedTags)
 {
-    const QString xml = buildDocumentXml (expandedTags);
+    const DocumentDimensions dims = calculateDocumentDimensions (layoutConfig);
 
-    zip.addFile ("word/document.xml", xml.toUtf8 ());
-}
+    compileTagPrograms (dims.tagWidth);
 
+    if (! zip.beginEntry ("word/document.xml") || ! zip.writeEntryData (createDocumentHead (dims)))
+        return false;
 
-QString WordGenerator::addSectionProperties (const DocumentDimensions &dims) const
-{
-    QString xml;
 
-    xml += "<w:p/>"; // Ensure there is a paragraph before section properties for maximum Word compatibility
+    // Tags are rendered in windows of whole pages, one window per worker, and written in document order.
+    // Windows split only at page boundaries and render through the same code, so the bytes match a serial run
+    struct RenderWindow
+    {
+        qint64 begin = 0;
+        qint64 end	 = 0;
+        QByteArray xml;
+    };
+
+    const qint64 total	  = expandedTags.size ();
+    const qint64 pageTags = qint64 (dims.columns) * std::max (1, dims.rows);
+    const qint64 window	  = pageTags * std::max<qint64> (1, (minRenderWindowTags + pageTags - 1) / pageTags);
+    const int workers	  = renderThreads > 0 ? renderThreads : std::max (1, QThread::idealThreadCount ());
+
+    const QByteArray separator = layoutConfig.tablePerPage ? createPageSeparator (dims) : QByteArray ();
+
+    QVector<RenderWindow> windows;
+
+    auto render = [this, &expandedTags, &dims, &separator, pageTags] (RenderWindow &w)
+    {
+        RenderedTagCache cache; // per window: workers share nothing
+
+        for (qint64 page = w.begin; page < w.end; page += pageTags)
+        {
+            if (page > 0)
+                w.xml += separator;
+
+            appendTableRows (w.xml, expandedTags, page, qMin (w.end, page + pageTags), dims.columns, cache);
+        }
+    };
+
 
-    xml += QString ("<w:sectPr><w:pgSz w:w=\"%1\" w:h=\"%2\"/><w:pgMar w:top=\"%3\" w:right=\"%4\" w:bottom=\"%5\" "
-                    "w:left=\"%6\"/></w:sectPr>")
-                   .arg (dims.pageWidthTwips)
-                   .arg (dims.pageHeightTwips)
-                   .arg (dims.marginTop)
-                   .arg (dims.marginRight)
-                   .arg (dims.marginBottom)
-                   .arg (dims.marginLeft);
+    for (qint64 first = 0; first < total;)
+    {
+        windows.clear ();
 
-    xml += "</w:body></w:document>";
+        for (int i = 0; i < workers && first < total; ++i, first += window)
+        {
+            RenderWindow w;
+            w.begin = first;
+            w.end	= qMin (total, first + window);
+            windows.append (w);
+        }
 
+        if (windows.size () > 1)
+            QtConcurrent::blockingMap (windows, render);
+        else
+            render (windows[0]);
+
+        for (const RenderWindow &w : windows)
+        {
+            if (! zip.writeEntryData (w.xml))
+                return false;
+        }
+    }
 
-    return xml;
+
+    return zip.writeEntryData (createDocumentTail (dims)) && zip.endEntry ();
 }
 
 
-QString WordGenerator::createDocumentHeader () const
+void WordGenerator::addSectionProperties (XmlByteBuilder &out, const DocumentDimensions &dims) const
 {
-    QString xml;
+    out << "<w:p/>"; // Ensure there is a paragraph before section properties for maximum Word compatibility
 
-    xml += "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>";
-    xml += "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\" "
-           "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">";
-    xml += "<w:body>";
+    out << "<w:sectPr><w:pgSz w:w=\"" << dims.pageWidthTwips << "\" w:h=\"" << dims.pageHeightTwips << "\"/><w:pgMar w:top=\""
+        << dims.marginTop << "\" w:right=\"" << dims.marginRight << "\" w:bottom=\"" << dims.marginBottom << "\" w:left=\""
+        << dims.marginLeft << "\"/></w:sectPr>";
+
+    out << "</w:body></w:document>";
+}
 
 
-    return xml;
+void WordGenerator::createDocumentHeader (XmlByteBuilder &out) const
+{
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>";
+    out << "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\" "
+           "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">";
+    out << "<w:body>";
 }
 
-QString WordGenerator::createOuterTableStructure (int tableWidth) const
+void WordGenerator::createOuterTableStructure (XmlByteBuilder &out, int tableWidth) const
 {
-    QString xml = "<w:tbl>";
+    out << "<w:tbl>";
 
-    xml += QString ("<w:tblPr><w:tblW w:w=\"%1\" w:type=\"dxa\"/><w:tblLayout w:type=\"fixed\"/>").arg (tableWidth);
-    xml += "<w:tblCellMar><w:top w:w=\"0\" w:type=\"dxa\"/><w:left w:w=\"0\" w:type=\"dxa\"/><w:bottom w:w=\"0\" w:type=\"dxa\"/><w:right "
+    out << "<w:tblPr><w:tblW w:w=\"" << tableWidth << "\" w:type=\"dxa\"/><w:tblLayout w:type=\"fixed\"/>";
+    out << "<w:tblCellMar><w:top w:w=\"0\" w:type=\"dxa\"/><w:left w:w=\"0\" w:type=\"dxa\"/><w:bottom w:w=\"0\" w:type=\"dxa\"/><w:right "
            "w:w=\"0\" w:type=\"dxa\"/></w:tblCellMar><w:tblBorders>";
 
     // Due to the way price tags are displayed in Word, only the right outer border needs to be thicker (12 = 25% thinner than 16)
-    xml += "<w:top w:val=\"single\" w:sz=\"4\"/><w:left w:val=\"single\" w:sz=\"4\"/><w:bottom w:val=\"single\" w:sz=\"4\"/><w:right "
+    out << "<w:top w:val=\"single\" w:sz=\"4\"/><w:left w:val=\"single\" w:sz=\"4\"/><w:bottom w:val=\"single\" w:sz=\"4\"/><w:right "
            "w:val=\"single\" w:sz=\"12\"/>";
-    xml += "<w:insideH w:val=\"single\" w:sz=\"4\"/><w:insideV w:val=\"single\" w:sz=\"4\"/></w:tblBorders></w:tblPr>";
-
-
-    return xml;
+    out << "<w:insideH w:val=\"single\" w:sz=\"4\"/><w:insideV w:val=\"single\" w:sz=\"4\"/></w:tblBorders></w:tblPr>";
 }
 
-QString WordGenerator::createOuterTableGrid (int columns, int tagWidth) const
+void WordGenerator::createOuterTableGrid (XmlByteBuilder &out, int columns, int tagWidth) const
 {
-    QString xml = "<w:tblGrid>";
+    out << "<w:tblGrid>";
 
     for (int c = 0; c < columns; ++c)
-        xml += QString ("<w:gridCol w:w=\"%1\"/>").arg (tagWidth);
-    xml += "</w:tblGrid>";
-
-
-    return xml;
+        out << "<w:gridCol w:w=\"" << tagWidth << "\"/>";
+    out << "</w:tblGrid>";
 }
 
 
-QString WordGenerator::xmlEscape (const QString &s) { return xmlEscapeLocal (s); }
+QString WordGenerator::xmlEscape (const QString &s) { return XmlEscape::escaped (s); }
 
 
 WordGenerator::DocumentDimensions WordGenerator::calculateDocumentDimensions (const DocxLayoutConfig &layoutConfig) const
@@ -765,52 +919,151 @@ WordGenerator::DocumentDimensions WordGenerator::calculateDocumentDimensions (co
 }
 
 
-QString WordGenerator::buildDocumentXml (const QList<PriceTag> &expandedTags)
+QByteArray WordGenerator::createDocumentHead (const DocumentDimensions &dims) const
 {
-    const WordGenerator::DocumentDimensions dims = calculateDocumentDimensions (layoutConfig);
-    const int outerTableWidth					 = dims.tagWidth * dims.columns;
+    XmlByteBuilder xml (1024);
 
-    QString xml = createDocumentHeader ();
-    xml += createOuterTableStructure (outerTableWidth);
-    xml += createOuterTableGrid (dims.columns, dims.tagWidth);
-    xml += addTableRows (expandedTags, dims.columns, dims.tagWidth);
-    xml += "</w:tbl>";
-    xml += addSectionProperties (dims);
+    createDocumentHeader (xml);
+    createOuterTableStructure (xml, dims.tagWidth * dims.columns);
+    createOuterTableGrid (xml, dims.columns, dims.tagWidth);
 
 
-    return xml;
+    return xml.take ();
 }
 
+QByteArray WordGenerator::createPageSeparator (const DocumentDimensions &dims) const
+{
+    XmlByteBuilder xml (1024);
+
+    // Tables need a paragraph between them or Word merges them; this one carries the page break
+    xml << "</w:tbl><w:p><w:pPr><w:pageBreakBefore/><w:spacing w:before=\"0\" w:after=\"0\" w:line=\"" << pageSeparatorTwips
+        << "\" w:lineRule=\"exact\"/><w:rPr><w:sz w:val=\"2\"/></w:rPr></w:pPr></w:p>";
+
+    createOuterTableStructure (xml, dims.tagWidth * dims.columns);
+    createOuterTableGrid (xml, dims.columns, dims.tagWidth);
 
-QString WordGenerator::addTableRows (const QList<PriceTag> &expandedTags, int columns, int tagWidth) const
+
+    return xml.take ();
+}
+
+QByteArray WordGenerator::createDocumentTail (const DocumentDimensions &dims) const
 {
-    QString xml;
-    int idx = 0;
+    XmlByteBuilder xml (256);
+
+    xml << "</w:tbl>";
+    addSectionProperties (xml, dims);
+
+
+    return xml.take ();
+}
+
+
+void WordGenerator::compileTagPrograms (int tagWidth)
+{
+    QString markers[TagSlotCount];
+
+    for (int slot = 0; slot < TagSlotCount; ++slot)
+        markers[slot] = QString (TagFragmentProgram::slotMarker (slot));
+
+    XmlByteBuilder xml (16 * 1024);
 
-    const int total		= expandedTags.size ();
-    const int totalRows = (total + columns - 1) / columns;
+    makeInnerTagTable (xml, markers, false, tagTemplate, tagWidth);
+    regularTagProgram.compile (xml.take (), SlotPrice2);
 
+    makeInnerTagTable (xml, markers, true, tagTemplate, tagWidth);
+    discountedTagProgram.compile (xml.take (), TagSlotCount);
 
-    for (int r = 0; r < totalRows; ++r)
+    createTableCellProperties (xml, tagWidth);
+    tagCellOpen = xml.take ();
+
+    paragraph (xml, "");
+    emptyCellContent = xml.take ();
+    compiledTagWidth = tagWidth;
+}
+
+QByteArray WordGenerator::renderTag (const PriceTag &tag) const
+{
+    QString values[TagSlotCount];
+
+    const bool discounted			  = collectTagValues (tag, tagTemplate, values);
+    const TagFragmentProgram &program = discounted ? discountedTagProgram : regularTagProgram;
+
+    if (program.isValid ())
     {
-        xml += "<w:tr><w:trPr><w:cantSplit/></w:trPr>";
+        QByteArray out;
+        program.render (out, values);
+
+        return out;
+    }
+
+    XmlByteBuilder xml (4 * 1024);
+    makeInnerTagTable (xml, values, discounted, tagTemplate, compiledTagWidth);
+
+
+    return xml.take ();
+}
+
+
+void WordGenerator::appendTableRows (QByteArray &out, const ExpandedTagView &expandedTags, qint64 begin, qint64 end, int columns,
+                                     RenderedTagCache &cache) const
+{
+    const PriceTagTable &table	   = expandedTags.table ();
+    const QVector<quint64> &hashes = table.rowHashes ();
+    QVector<QByteArray> cells;
+
+    // Rendered once per distinct content in the window: copies of a row and rows with equal content reuse the bytes.
+    // A hash hit is confirmed against the row the bytes came from; on a collision the newer row takes the slot.
+    // The programs are recompiled per generation, so the template is part of the key implicitly
+    QByteArray fragment;
+    int currentRow = -1;
+
 
-        for (int c = 0; c < columns; ++c)
+    for (qint64 first = begin; first < end; first += columns)
+    {
+        const qint64 last = qMin (end, first + columns);
+
+        cells.clear ();
+
+        for (qint64 idx = first; idx < last; ++idx)
         {
-            xml += createTableCellProperties (tagWidth);
+            const int row = expandedTags.slot (idx).row;
+
+            if (row != currentRow)
+            {
+                RenderedTag &cached = cache[hashes.at (row)];
+
+                if (cached.row < 0 || (cached.row != row && ! table.sameContent (cached.row, row)))
+                {
+                    cached.row = row;
+                    cached.xml = renderTag (table.at (row));
+                }
 
-            if (idx < total)
-                xml += makeInnerTagTable (expandedTags[idx], tagTemplate, tagWidth);
-            else
-                xml += paragraph ("");
+                fragment   = cached.xml;
+                currentRow = row;
+            }
 
-            xml += "</w:tc>";
-            ++idx;
+            cells.append (fragment);
         }
 
-        xml += "</w:tr>";
+        appendTableRow (out, cells, columns);
     }
+}
 
+void WordGenerator::appendTableRow (QByteArray &out, const QVector<QByteArray> &cells, int columns) const
+{
+    out += "<w:tr><w:trPr><w:cantSplit/></w:trPr>";
+
+    for (int c = 0; c < columns; ++c)
+    {
+        out += tagCellOpen;
+
+        if (c < cells.size ())
+            out += cells.at (c);
+        else
+            out += emptyCellContent;
+
+        out += "</w:tc>";
+    }
 
-    return xml;
+    out += "</w:tr>";
 }
@@ -0,0 +1,535 @@
+#include "ZipStreamWriter.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QtEndian>
+#include <limits>
+
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+#include <zlib.h>
+
+
+namespace
+{
+    const quint32 localHeaderSignature	   = 0x04034b50;
+    const quint32 centralHeaderSignature   = 0x02014b50;
+    const quint32 endOfCentralDirSignature = 0x06054b50;
+
+    const int localHeaderSize	   = 30;
+    const int localHeaderCrcOffset = 14;
+
+    const quint16 versionNeeded	 = 20;
+    const quint16 flagUtf8Names	 = 0x0800;
+    const quint16 methodStored	 = 0;
+    const quint16 methodDeflated = 8;
+
+    const qint64 maxZip32Size = std::numeric_limits<quint32>::max ();
+
+    const int deflateChunkSize	= 64 * 1024;
+    const int parallelBlockSize = 1024 * 1024;
+    const int deflateWindowSize = 32 * 1024; // dictionary carried into the next block
+
+
+    void appendU16 (QByteArray &out, quint16 value)
+    {
+        char bytes[2];
+        qToLittleEndian (value, bytes);
+        out.append (bytes, 2);
+    }
+
+    void appendU32 (QByteArray &out, quint32 value)
+    {
+        char bytes[4];
+        qToLittleEndian (value, bytes);
+        out.append (bytes, 4);
+    }
+
+
+    quint32 crc32Update (quint32 crc, const char *data, qint64 size)
+    {
+        // zlib counts in uInt: feed very large blocks in pieces
+        while (size > 0)
+        {
+            const uInt piece = uInt (qMin<qint64> (size, std::numeric_limits<uInt>::max ()));
+
+            crc = quint32 (crc32 (crc, reinterpret_cast<const Bytef *> (data), piece));
+            data += piece;
+            size -= piece;
+        }
+
+
+        return crc;
+    }
+
+
+    int zlibLevel (ZipCompression compression)
+    {
+        switch (compression)
+        {
+            case ZipCompression::Fast:
+                return Z_BEST_SPEED;
+            case ZipCompression::Max:
+                return Z_BEST_COMPRESSION;
+            default:
+                return Z_DEFAULT_COMPRESSION;
+        }
+    }
+
+
+    // One block of a Max entry. Every block but the last ends with a sync flush (byte aligned, not final),
+    // so the outputs concatenated in order form a single deflate stream
+    struct DeflateBlock
+    {
+        const char *dictionary = nullptr;
+        int dictionaryLength   = 0;
+        const char *data	   = nullptr;
+        int length			   = 0;
+        bool last			   = false;
+
+        QByteArray out;
+        bool ok = false;
+    };
+
+    void deflateBlock (DeflateBlock &block)
+    {
+        z_stream stream{};
+
+        if (deflateInit2 (&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return;
+
+        if (block.dictionaryLength > 0)
+            deflateSetDictionary (&stream, reinterpret_cast<const Bytef *> (block.dictionary), uInt (block.dictionaryLength));
+
+        const int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+
+        block.out.resize (int (deflateBound (&stream, uLong (block.length))) + 16);
+
+        stream.next_in	 = reinterpret_cast<Bytef *> (const_cast<char *> (block.data));
+        stream.avail_in	 = uInt (block.length);
+        stream.next_out	 = reinterpret_cast<Bytef *> (block.out.data ());
+        stream.avail_out = uInt (block.out.size ());
+
+
+        for (;;)
+        {
+            const int ret = deflate (&stream, flush);
+
+            if (ret == Z_STREAM_ERROR)
+                break;
+
+            // Done once the flush completed with output space to spare; otherwise grow and call again
+            if (block.last ? ret == Z_STREAM_END : (stream.avail_in == 0 && stream.avail_out > 0))
+            {
+                block.ok = true;
+
+                break;
+            }
+
+            const int produced = int (stream.total_out);
+
+            block.out.resize (block.out.size () * 2);
+            stream.next_out	 = reinterpret_cast<Bytef *> (block.out.data () + produced);
+            stream.avail_out = uInt (block.out.size () - produced);
+        }
+
+        block.out.resize (int (stream.total_out));
+        deflateEnd (&stream);
+    }
+} // namespace
+
+
+struct ZipStreamWriter::Deflater
+{
+    z_stream stream{};
+    QByteArray chunk;
+
+    // Max: input buffered until a batch of blocks is ready, after dictionaryLength bytes kept from the last batch
+    bool blocks = false;
+    QByteArray pending;
+    int dictionaryLength = 0;
+};
+
+
+ZipStreamWriter::ZipStreamWriter (const QString &filePath, ZipCompression compression) : file (filePath), level (compression)
+{
+    if (! file.open (QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug () << "Cannot open file for write:" << filePath;
+
+        failed = true;
+
+        return;
+    }
+
+    const QDateTime now = QDateTime::currentDateTime ();
+
+    dosTime = quint16 ((now.time ().hour () << 11) | (now.time ().minute () << 5) | (now.time ().second () / 2));
+    dosDate = quint16 (((qMax (now.date ().year (), 1980) - 1980) << 9) | (now.date ().month () << 5) | now.date ().day ());
+}
+
+ZipStreamWriter::~ZipStreamWriter ()
+{
+    if (file.isOpen ())
+        close ();
+
+    delete deflater;
+}
+
+
+bool ZipStreamWriter::writeRaw (const char *data, qint64 size)
+{
+    if (file.write (data, size) != size)
+        return fail ("short write");
+
+
+    return true;
+}
+
+
+bool ZipStreamWriter::beginEntry (const QString &path)
+{
+    if (failed || ! file.isOpen ())
+        return false;
+
+    if (entryOpen)
+        return fail ("previous entry is still open");
+
+    if (file.pos () > maxZip32Size)
+        return fail ("archive exceeds 4 GB (ZIP64 is not supported)");
+
+    Entry entry;
+
+    entry.name				= path.toUtf8 ();
+    entry.localHeaderOffset = quint32 (file.pos ());
+    entry.method			= level == ZipCompression::Store ? methodStored : methodDeflated;
+
+    // CRC and sizes are zero for now and patched in endEntry
+    QByteArray header;
+    header.reserve (localHeaderSize + entry.name.size ());
+
+    appendU32 (header, localHeaderSignature);
+    appendU16 (header, versionNeeded);
+    appendU16 (header, flagUtf8Names);
+    appendU16 (header, entry.method);
+    appendU16 (header, dosTime);
+    appendU16 (header, dosDate);
+    appendU32 (header, 0);
+    appendU32 (header, 0);
+    appendU32 (header, 0);
+    appendU16 (header, quint16 (entry.name.size ()));
+    appendU16 (header, 0);
+    header.append (entry.name);
+
+    if (! writeRaw (header.constData (), header.size ()))
+        return false;
+
+
+    if (entry.method == methodDeflated)
+    {
+        if (! deflater)
+            deflater = new Deflater ();
+
+        deflater->blocks = level == ZipCompression::Max;
+        deflater->pending.clear ();
+        deflater->dictionaryLength = 0;
+
+        deflater->stream = z_stream{};
+        deflater->chunk.resize (deflateChunkSize);
+
+        // Negative window bits: raw deflate stream without zlib header, as stored in ZIP
+        if (! deflater->blocks &&
+            deflateInit2 (&deflater->stream, zlibLevel (level), Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return fail ("deflateInit2");
+    }
+
+    entries.append (entry);
+
+    entryOpen	   = true;
+    entryDataStart = file.pos ();
+    entryRawSize   = 0;
+    entryCrc	   = 0;
+
+
+    return true;
+}
+
+
+bool ZipStreamWriter::writeEntryData (const char *data, qint64 size)
+{
+    if (failed || ! entryOpen)
+        return false;
+
+    if (size <= 0)
+        return true;
+
+    entryRawSize += size;
+
+    if (entryRawSize > maxZip32Size)
+        return fail ("entry exceeds 4 GB (ZIP64 is not supported)");
+
+
+    entryCrc = crc32Update (entryCrc, data, size);
+
+    if (entries.last ().method == methodStored)
+        return writeRaw (data, size);
+
+
+    if (deflater->blocks)
+    {
+        const qint64 batchSize = qint64 (parallelBlockSize) * qMax (1, QThread::idealThreadCount ());
+
+        while (size > 0)
+        {
+            const int piece = int (qMin<qint64> (size, parallelBlockSize));
+
+            deflater->pending.append (data, piece);
+            data += piece;
+            size -= piece;
+
+            if (deflater->pending.size () - deflater->dictionaryLength >= batchSize && ! deflateBlocks (false))
+                return false;
+        }
+
+
+        return true;
+    }
+
+    // zlib counts in uInt: feed very large blocks in pieces
+    while (size > 0)
+    {
+        const uInt piece = uInt (qMin<qint64> (size, std::numeric_limits<uInt>::max ()));
+
+        z_stream &stream = deflater->stream;
+
+        stream.next_in	= reinterpret_cast<Bytef *> (const_cast<char *> (data));
+        stream.avail_in = piece;
+
+        while (stream.avail_in > 0)
+        {
+            stream.next_out	 = reinterpret_cast<Bytef *> (deflater->chunk.data ());
+            stream.avail_out = uInt (deflater->chunk.size ());
+
+            if (deflate (&stream, Z_NO_FLUSH) == Z_STREAM_ERROR)
+                return fail ("deflate");
+
+            if (! writeRaw (deflater->chunk.constData (), deflater->chunk.size () - stream.avail_out))
+                return false;
+        }
+
+        data += piece;
+        size -= piece;
+    }
+
+
+    return true;
+}
+
+
+bool ZipStreamWriter::deflateBlocks (bool finish)
+{
+    QByteArray &pending = deflater->pending;
+    const int available = pending.size ();
+    int offset			= deflater->dictionaryLength;
+
+    QVector<DeflateBlock> blocks;
+
+
+    // Whole blocks only, unless finishing; a finished entry always ends with a final block, even an empty one
+    while (available - offset >= parallelBlockSize || (finish && (offset < available || blocks.isEmpty ())))
+    {
+        const int dictionaryStart = qMax (0, offset - deflateWindowSize);
+
+        DeflateBlock block;
+        block.dictionary	   = pending.constData () + dictionaryStart;
+        block.dictionaryLength = offset - dictionaryStart;
+        block.data			   = pending.constData () + offset;
+        block.length		   = qMin (parallelBlockSize, available - offset);
+        blocks.append (block);
+
+        offset += block.length;
+    }
+
+    if (blocks.isEmpty ())
+        return true;
+
+    blocks.last ().last = finish;
+
+    if (blocks.size () > 1)
+        QtConcurrent::blockingMap (blocks, deflateBlock);
+    else
+        deflateBlock (blocks[0]);
+
+
+    for (const DeflateBlock &block : blocks)
+    {
+        if (! block.ok)
+            return fail ("deflate block");
+
+        if (! writeRaw (block.out.constData (), block.out.size ()))
+            return false;
+    }
+
+    // The tail of the consumed input primes the first block of the next batch
+    const int keep = qMin (offset, deflateWindowSize);
+
+    pending.remove (0, offset - keep);
+    deflater->dictionaryLength = keep;
+
+
+    return true;
+}
+
+
+bool ZipStreamWriter::endEntry ()
+{
+    if (failed || ! entryOpen)
+        return false;
+
+    entryOpen = false;
+
+
+    if (entries.last ().method == methodDeflated && deflater->blocks)
+    {
+        if (! deflateBlocks (true))
+            return false;
+    }
+    else if (entries.last ().method == methodDeflated)
+    {
+        z_stream &stream = deflater->stream;
+        int ret			 = Z_OK;
+
+        stream.next_in	= nullptr;
+        stream.avail_in = 0;
+
+        while (ret != Z_STREAM_END)
+        {
+            stream.next_out	 = reinterpret_cast<Bytef *> (deflater->chunk.data ());
+            stream.avail_out = uInt (deflater->chunk.size ());
+
+            ret = deflate (&stream, Z_FINISH);
+
+            if (ret == Z_STREAM_ERROR)
+            {
+                deflateEnd (&stream);
+
+                return fail ("deflate finish");
+            }
+
+            if (! writeRaw (deflater->chunk.constData (), deflater->chunk.size () - stream.avail_out))
+            {
+                deflateEnd (&stream);
+
+                return false;
+            }
+        }
+
+        deflateEnd (&stream);
+    }
+
+
+    const qint64 entryEnd		= file.pos ();
+    const qint64 compressedSize = entryEnd - entryDataStart;
+
+    if (compressedSize > maxZip32Size)
+        return fail ("entry exceeds 4 GB (ZIP64 is not supported)");
+
+    Entry &entry = entries.last ();
+
+    entry.crc			   = entryCrc;
+    entry.compressedSize   = quint32 (compressedSize);
+    entry.uncompressedSize = quint32 (entryRawSize);
+
+
+    QByteArray sizes;
+
+    appendU32 (sizes, entry.crc);
+    appendU32 (sizes, entry.compressedSize);
+    appendU32 (sizes, entry.uncompressedSize);
+
+    if (! file.seek (entry.localHeaderOffset + localHeaderCrcOffset) || ! writeRaw (sizes.constData (), sizes.size ()))
+        return fail ("cannot patch local header");
+
+    if (! file.seek (entryEnd))
+        return fail ("seek");
+
+
+    return true;
+}
+
+
+bool ZipStreamWriter::close ()
+{
+    if (! file.isOpen ())
+        return ! failed;
+
+    if (entryOpen)
+        endEntry ();
+
+    const qint64 directoryOffset = file.pos ();
+
+    if (! failed && directoryOffset > maxZip32Size)
+        fail ("archive exceeds 4 GB (ZIP64 is not supported)");
+
+
+    if (! failed)
+    {
+        QByteArray directory;
+
+        for (const Entry &entry : entries)
+        {
+            appendU32 (directory, centralHeaderSignature);
+            appendU16 (directory, versionNeeded); // version made by
+            appendU16 (directory, versionNeeded);
+            appendU16 (directory, flagUtf8Names);
+            appendU16 (directory, entry.method);
+            appendU16 (directory, dosTime);
+            appendU16 (directory, dosDate);
+            appendU32 (directory, entry.crc);
+            appendU32 (directory, entry.compressedSize);
+            appendU32 (directory, entry.uncompressedSize);
+            appendU16 (directory, quint16 (entry.name.size ()));
+            appendU16 (directory, 0); // extra
+            appendU16 (directory, 0); // comment
+            appendU16 (directory, 0); // disk
+            appendU16 (directory, 0); // internal attributes
+            appendU32 (directory, 0); // external attributes
+            appendU32 (directory, entry.localHeaderOffset);
+            directory.append (entry.name);
+        }
+
+        const quint32 directorySize = quint32 (directory.size ());
+
+        appendU32 (directory, endOfCentralDirSignature);
+        appendU16 (directory, 0);
+        appendU16 (directory, 0);
+        appendU16 (directory, quint16 (entries.size ()));
+        appendU16 (directory, quint16 (entries.size ()));
+        appendU32 (directory, directorySize);
+        appendU32 (directory, quint32 (directoryOffset));
+        appendU16 (directory, 0);
+
+        writeRaw (directory.constData (), directory.size ());
+    }
+
+    file.close ();
+
+
+    return ! failed;
+}
+
+
+bool ZipStreamWriter::fail (const char *reason)
+{
+    qDebug () << "ZIP write failed:" << reason << file.fileName ();
+
+    failed = true;
+
+
+    return false;
+}
+
+bool ZipStreamWriter::addFile (const QString &path, const QByteArray &data)
+{
+    return beginEntry (path) && writeEntryData (data) && endEntry ();
+}